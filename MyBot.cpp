@@ -121,23 +121,26 @@ int turns_till_attackable(const hlt::Entity& a, const hlt::Entity& b) {
 
 
 hlt::Ship nearest_ship(const hlt::Map& map, const hlt::Ship& a, hlt::PlayerId local_player) {
+  // Compare squared distances and only copy the winner.
   auto nearest_distance = std::numeric_limits<double>::max();
-  hlt::Ship nearest_target;
+  const hlt::Ship* nearest_target = nullptr;
   for (const auto& e : map.ships) {
     if (e.first == local_player) {
       continue;
     }
 
     for (const auto& target : e.second) {
-      auto distance = a.location.get_distance_to(target.location);
+      const auto dx = a.location.pos_x - target.location.pos_x;
+      const auto dy = a.location.pos_y - target.location.pos_y;
+      const auto distance = dx * dx + dy * dy;
       if (distance < nearest_distance) {
         nearest_distance = distance;
-        nearest_target = target;
+        nearest_target = &target;
       }
     }
   }
 
-  return nearest_target;
+  return nearest_target ? *nearest_target : hlt::Ship();
 
 }
 
@@ -230,10 +233,10 @@ void initialise_planet_dock_points(const hlt::Map& map)
 
 void accelerate_by(hlt::Location& loc, int thrust, int angle_in_degrees)
 {
-  auto angle_rads = angle_in_degrees * M_PI / 180.0;
+  const auto displacement = raf::math::Velocity(thrust, angle_in_degrees).to_vec();
 
-  loc.pos_x += thrust * std::cos(angle_rads);
-  loc.pos_y += thrust * std::sin(angle_rads);
+  loc.pos_x += displacement.x();
+  loc.pos_y += displacement.y();
 }
 
 static raf::math::Vec2d to_vec2(const hlt::Location& loc) {
@@ -397,6 +400,7 @@ void new_main() {
   );
 
   update_raf_map_state(map_state, initial_map);
+  map_state.pre_game();
 
   for (int frame = 1;; frame++) {
     hlt::Map map = hlt::in::get_map();
@@ -51,10 +51,10 @@ namespace hlt {
 
         static void accelerate_by(hlt::Location& loc, int thrust, int angle_in_degrees)
         {
-          auto angle_rads = angle_in_degrees * M_PI / 180.0;
+          const auto displacement = raf::math::Velocity(thrust, angle_in_degrees).to_vec();
 
-          loc.pos_x += thrust * std::cos(angle_rads);
-          loc.pos_y += thrust * std::sin(angle_rads);
+          loc.pos_x += displacement.x();
+          loc.pos_y += displacement.y();
         }
 
         static bool would_collide_in_transit(
@@ -0,0 +1,100 @@
+#include "approach_queue.hpp"
+
+#include <algorithm>
+
+namespace raf {
+namespace navigation {
+
+ApproachQueue::ApproachQueue(double horizon, double velocity_threshold, double threat_range)
+  : horizon_(horizon),
+  velocity_threshold_squared_(velocity_threshold * velocity_threshold),
+  threat_range_(threat_range),
+  // Two ships closing at full speed for the whole horizon.
+  reach_(horizon * 2 * constants::MAX_SPEED
+    + std::max(threat_range, constants::WEAPON_RADIUS + 2 * constants::SHIP_RADIUS)) {
+}
+
+void ApproachQueue::begin_frame(double now) {
+  now_ = now;
+}
+
+ApproachQueue::Tracked& ApproachQueue::tracked(game::EntityId id) {
+  const auto index = static_cast<size_t>(id);
+  if (index >= tracked_.size()) {
+    tracked_.resize(index + 1, { math::Vec2d::Zero(), 0.0, 0, false });
+  }
+  return tracked_[index];
+}
+
+void ApproachQueue::update(const game::Ship& ship, const game::HierarchicalGrid<game::Ship>& neighbours) {
+  auto& entry = tracked(ship.id());
+  if (entry.live &&
+    now_ < entry.evaluated + horizon_ &&
+    (ship.velocity() - entry.velocity).length_squared() <= velocity_threshold_squared_) {
+    return;
+  }
+
+  // Bumping the version retires every event already queued for this ship.
+  entry.velocity = ship.velocity();
+  entry.evaluated = now_;
+  entry.version++;
+  entry.live = true;
+  evaluations_++;
+
+  neighbours.for_each_in_range(ship.current_location(), reach_, [&](const game::Ship& other) {
+    if (other.id() == ship.id()) {
+      return;
+    }
+    push(ship, other, Range::Collision, ship.radius() + other.radius());
+    push(ship, other, Range::Weapon, ship.radius() + other.radius() + constants::WEAPON_RADIUS);
+    if (threat_range_ > 0.0) {
+      push(ship, other, Range::Threat, threat_range_);
+    }
+  });
+}
+
+void ApproachQueue::remove(const game::Ship& ship) {
+  auto& entry = tracked(ship.id());
+  entry.version++;
+  entry.live = false;
+}
+
+void ApproachQueue::push(const game::Ship& a, const game::Ship& b, Range range, double distance) {
+  const auto interval = math::approach_interval(
+    a.current_location(), a.velocity(), b.current_location(), b.velocity(), distance);
+  // Beyond the horizon the pair is predicted again before it gets there, and
+  // a queued event would sit in the heap until then for nothing.
+  if (interval.first > horizon_) {
+    return;
+  }
+  // b may not have been updated yet this frame, in which case its version
+  // changes when it is and this event is superseded by its own.
+  const auto version_b = tracked(b.id()).version;
+  queue_.push({
+    { now_ + interval.first, now_ + interval.second, a.id(), b.id(), range },
+    tracked_[a.id()].version,
+    version_b });
+}
+
+bool ApproachQueue::is_current(const Event& event) const {
+  const auto& a = tracked_[event.approach.a];
+  const auto& b = tracked_[event.approach.b];
+  return a.live && a.version == event.version_a && b.version == event.version_b;
+}
+
+void ApproachQueue::collect(double until) {
+  active_.erase(std::remove_if(std::begin(active_), std::end(active_), [this](const Event& event) {
+    return event.approach.exit < now_ || !is_current(event);
+  }), std::end(active_));
+
+  while (!queue_.empty() && queue_.top().approach.enter <= until) {
+    const auto event = queue_.top();
+    queue_.pop();
+    if (event.approach.exit >= now_ && is_current(event)) {
+      active_.push_back(event);
+    }
+  }
+}
+
+}
+}
@@ -0,0 +1,129 @@
+#ifndef RAF_GAME_APPROACH_QUEUE_H_
+#define RAF_GAME_APPROACH_QUEUE_H_
+
+#include "hierarchical_grid.hpp"
+#include "ship.hpp"
+#include "../math/math.hpp"
+
+#include <queue>
+#include <vector>
+
+namespace raf {
+namespace navigation {
+
+// Turns ahead each ship's pairs are predicted for before they are checked again.
+constexpr double DEFAULT_APPROACH_HORIZON = 3.0;
+
+// Change in a ship's velocity, per turn, that invalidates its predictions.
+constexpr double DEFAULT_APPROACH_VELOCITY_THRESHOLD = 0.5;
+
+// Predicted times at which pairs of ships come within weapon or collision
+// range, assuming they keep their current velocities.
+//
+// A kinetic structure: each ship's pairs are predicted once and stay valid
+// until its velocity changes by more than a threshold, or its horizon runs
+// out. Ships flying a steady course cost nothing per frame, and finding the
+// threats due by a given time is a walk of a priority queue rather than a
+// pass over every pair.
+//
+// Predictions are only as good as the velocities. A ship whose velocity
+// drifts within the threshold keeps its old predictions, which can be out
+// by up to the threshold per turn since they were made.
+class ApproachQueue {
+public:
+  enum class Range {
+    Collision,
+    Weapon,
+    // Centers within the threat range given at construction.
+    Threat,
+  };
+
+  struct Approach {
+    // Absolute times, in turns, the pair comes within range and leaves it.
+    double enter;
+    double exit;
+    game::EntityId a;
+    game::EntityId b;
+    Range range;
+  };
+
+  // threat_range is a center to center distance, pairs are only reported
+  // for it when it is positive.
+  ApproachQueue(
+    double horizon = DEFAULT_APPROACH_HORIZON,
+    double velocity_threshold = DEFAULT_APPROACH_VELOCITY_THRESHOLD,
+    double threat_range = 0.0);
+
+  // Start a frame at the given turn. Time must not go backwards.
+  void begin_frame(double now);
+
+  // Refresh a ship's predictions if it changed course or they ran out.
+  // neighbours must hold every live ship, ship included, at their current
+  // locations.
+  void update(const game::Ship& ship, const game::HierarchicalGrid<game::Ship>& neighbours);
+
+  // Forget a ship and every prediction involving it.
+  void remove(const game::Ship& ship);
+
+  // Call func(const Approach&) for every pair within range at some point
+  // between now and until. A pair within both ranges is reported for both.
+  // Only approaches predicted to start within the horizon are kept, so until
+  // should be no later than now plus the horizon.
+  template<typename Func>
+  void for_each_due(double until, Func func) {
+    collect(until);
+    for (const auto& event : active_) {
+      if (event.approach.enter <= until) {
+        func(event.approach);
+      }
+    }
+  }
+
+  // Number of ships re-predicted since construction, for profiling.
+  size_t evaluations() const { return evaluations_; }
+  // Events waiting in the queue, stale ones included, for profiling.
+  size_t queued() const { return queue_.size(); }
+
+private:
+  struct Tracked {
+    math::Vec2d velocity;
+    double evaluated;
+    int version;
+    bool live;
+  };
+
+  struct Event {
+    Approach approach;
+    int version_a;
+    int version_b;
+
+    // Earliest first in the priority queue.
+    bool operator<(const Event& other) const {
+      return approach.enter > other.approach.enter;
+    }
+  };
+
+  Tracked& tracked(game::EntityId id);
+  bool is_current(const Event& event) const;
+  void push(const game::Ship& a, const game::Ship& b, Range range, double distance);
+
+  // Move due events from the queue into active_, dropping stale ones.
+  void collect(double until);
+
+  double horizon_;
+  double velocity_threshold_squared_;
+  double threat_range_;
+  double reach_;
+  double now_ = 0.0;
+  size_t evaluations_ = 0;
+  // Indexed by entity id.
+  std::vector<Tracked> tracked_;
+  std::priority_queue<Event> queue_;
+  // Popped events whose pair has not yet left range.
+  std::vector<Event> active_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_APPROACH_QUEUE_H_
@@ -0,0 +1,307 @@
+#include "approach_queue.hpp"
+#include "hierarchical_grid.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using raf::game::EntityId;
+using raf::game::HierarchicalGrid;
+using raf::game::Ship;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+using raf::navigation::ApproachQueue;
+
+using Pair = std::tuple<EntityId, EntityId, ApproachQueue::Range>;
+
+static Pair pair_of(EntityId a, EntityId b, ApproachQueue::Range range) {
+  return Pair(std::min(a, b), std::max(a, b), range);
+}
+
+// Every pair within range at some point in the next turn, by a full
+// pairwise pass.
+static std::vector<Pair> pairwise(const std::vector<Ship>& ships) {
+  std::vector<Pair> pairs;
+  for (size_t i = 0; i < ships.size(); i++) {
+    for (size_t j = i + 1; j < ships.size(); j++) {
+      const auto& a = ships[i];
+      const auto& b = ships[j];
+      const double collision = a.radius() + b.radius();
+      const double weapon = collision + raf::constants::WEAPON_RADIUS;
+      if (raf::math::approach_interval(a.current_location(), a.velocity(), b.current_location(), b.velocity(), collision).first <= 1.0) {
+        pairs.push_back(pair_of(a.id(), b.id(), ApproachQueue::Range::Collision));
+      }
+      if (raf::math::approach_interval(a.current_location(), a.velocity(), b.current_location(), b.velocity(), weapon).first <= 1.0) {
+        pairs.push_back(pair_of(a.id(), b.id(), ApproachQueue::Range::Weapon));
+      }
+    }
+  }
+  std::sort(std::begin(pairs), std::end(pairs));
+  return pairs;
+}
+
+static std::vector<Pair> due(ApproachQueue& queue, double until) {
+  std::vector<Pair> pairs;
+  queue.for_each_due(until, [&pairs](const ApproachQueue::Approach& approach) {
+    pairs.push_back(pair_of(approach.a, approach.b, approach.range));
+  });
+  std::sort(std::begin(pairs), std::end(pairs));
+  return pairs;
+}
+
+TEST(raf_approach_queue, approach_interval)
+{
+  const double never = std::numeric_limits<double>::infinity();
+
+  // Head on, closing 4 per turn from 10 apart.
+  auto interval = raf::math::approach_interval({ 0, 0 }, { 2, 0 }, { 10, 0 }, { -2, 0 }, 2);
+  ASSERT_DOUBLE_EQ(2.0, interval.first);
+  ASSERT_DOUBLE_EQ(3.0, interval.second);
+
+  // Already within range.
+  interval = raf::math::approach_interval({ 0, 0 }, { 1, 0 }, { 1, 0 }, { 0, 0 }, 2);
+  ASSERT_DOUBLE_EQ(0.0, interval.first);
+  ASSERT_DOUBLE_EQ(3.0, interval.second);
+
+  // Moving apart.
+  interval = raf::math::approach_interval({ 0, 0 }, { -1, 0 }, { 10, 0 }, { 1, 0 }, 2);
+  ASSERT_EQ(never, interval.first);
+
+  // Passing wide.
+  interval = raf::math::approach_interval({ 0, 0 }, { 1, 0 }, { 10, 5 }, { 0, 0 }, 2);
+  ASSERT_EQ(never, interval.first);
+
+  // Same velocity, constant distance.
+  ASSERT_EQ(never, raf::math::approach_interval({ 0, 0 }, { 1, 1 }, { 5, 0 }, { 1, 1 }, 2).first);
+  ASSERT_EQ(0.0, raf::math::approach_interval({ 0, 0 }, { 1, 1 }, { 1, 0 }, { 1, 1 }, 2).first);
+}
+
+// Within a turn, approach_interval agrees with min_dist_squared.
+TEST(raf_approach_queue, approach_interval_matches_min_dist)
+{
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<double> coordinate(-20, 20);
+  std::uniform_real_distribution<double> velocity(-7, 7);
+  std::uniform_real_distribution<double> distance(0.5, 8);
+
+  for (int i = 0; i < 10000; i++) {
+    const Vec2d a(coordinate(rng), coordinate(rng));
+    const Vec2d b(coordinate(rng), coordinate(rng));
+    const Vec2d a_vel(velocity(rng), velocity(rng));
+    const Vec2d b_vel(velocity(rng), velocity(rng));
+    const double d = distance(rng);
+
+    const double min_dist = raf::math::min_dist_squared(a, a_vel, b, b_vel);
+    if (std::abs(min_dist - d * d) < 1e-9) {
+      continue;
+    }
+    ASSERT_EQ(min_dist <= d * d, raf::math::approach_interval(a, a_vel, b, b_vel, d).first <= 1.0) << i;
+  }
+}
+
+// Moves every ship along its velocity. Some ships change course, by more
+// than the threshold, each turn.
+static void advance(std::vector<Ship>& ships, std::vector<Vec2d>& velocities, std::mt19937& rng) {
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  for (size_t i = 0; i < ships.size(); i++) {
+    if (unit(rng) < 0.1) {
+      const double a = angle(rng);
+      const double speed = 1 + unit(rng) * 6;
+      velocities[i] = { speed * std::cos(a), speed * std::sin(a) };
+    }
+    ships[i].update_location(ships[i].current_location() + velocities[i]);
+  }
+}
+
+TEST(raf_approach_queue, matches_pairwise)
+{
+  const Vec2i dimensions(200, 200);
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> coordinate(0, 200);
+  std::vector<Ship> ships;
+  std::vector<Vec2d> velocities(150);
+  for (EntityId id = 0; id < 150; id++) {
+    ships.emplace_back(id, id % 2, Vec2d{ coordinate(rng), coordinate(rng) }, 0.5, 255);
+  }
+
+  ApproachQueue queue;
+  for (int turn = 0; turn < 40; turn++) {
+    advance(ships, velocities, rng);
+    HierarchicalGrid<Ship> grid(dimensions);
+    for (const auto& ship : ships) {
+      grid.insert(ship);
+    }
+
+    queue.begin_frame(turn);
+    for (const auto& ship : ships) {
+      queue.update(ship, grid);
+    }
+    ASSERT_EQ(pairwise(ships), due(queue, turn + 1.0)) << "turn " << turn;
+  }
+}
+
+TEST(raf_approach_queue, steady_ships_are_not_repredicted)
+{
+  const Vec2i dimensions(100, 100);
+  std::vector<Ship> ships = {
+    Ship(0, 0, { 10, 50 }, 0.5, 255),
+    Ship(1, 1, { 90, 50 }, 0.5, 255),
+  };
+  ApproachQueue queue(20.0);
+  for (int turn = 0; turn < 10; turn++) {
+    ships[0].update_location(ships[0].current_location() + Vec2d(4, 0));
+    ships[1].update_location(ships[1].current_location() + Vec2d(-4, 0));
+    HierarchicalGrid<Ship> grid(dimensions);
+    for (const auto& ship : ships) {
+      grid.insert(ship);
+    }
+    queue.begin_frame(turn);
+    for (const auto& ship : ships) {
+      queue.update(ship, grid);
+    }
+
+    // Closing 8 per turn from 72 apart after the first move, so weapon range
+    // (6) is reached at 8.25 and collision (1) at 8.875.
+    const auto pairs = due(queue, turn + 1.0);
+    ASSERT_EQ(turn >= 8 ? 2u : 0u, pairs.size()) << "turn " << turn;
+  }
+  // Predicted once each on the first turn, then never again.
+  ASSERT_EQ(2u, queue.evaluations());
+}
+
+TEST(raf_approach_queue, removed_ships_are_dropped)
+{
+  const Vec2i dimensions(100, 100);
+  std::vector<Ship> ships = {
+    Ship(0, 0, { 50, 50 }, 0.5, 255),
+    Ship(1, 1, { 52, 50 }, 0.5, 255),
+  };
+  HierarchicalGrid<Ship> grid(dimensions);
+  for (const auto& ship : ships) {
+    grid.insert(ship);
+  }
+  ApproachQueue queue;
+  queue.begin_frame(0);
+  for (const auto& ship : ships) {
+    queue.update(ship, grid);
+  }
+  ASSERT_EQ(1u, due(queue, 1.0).size());
+
+  queue.remove(ships[1]);
+  ASSERT_TRUE(due(queue, 1.0).empty());
+}
+
+TEST(raf_approach_queue, threat_range)
+{
+  const Vec2i dimensions(100, 100);
+  std::vector<Ship> ships = {
+    Ship(0, 0, { 20, 50 }, 0.5, 255),
+    Ship(1, 1, { 60, 50 }, 0.5, 255),
+  };
+  ApproachQueue queue(3.0, 0.5, 24.0);
+  for (int turn = 0; turn < 6; turn++) {
+    ships[1].update_location(ships[1].current_location() + Vec2d(-4, 0));
+    HierarchicalGrid<Ship> grid(dimensions);
+    for (const auto& ship : ships) {
+      grid.insert(ship);
+    }
+    queue.begin_frame(turn);
+    for (const auto& ship : ships) {
+      queue.update(ship, grid);
+    }
+
+    // 36 apart after the first move, closing 4 per turn.
+    const auto pairs = due(queue, turn);
+    const bool within = ships[0].distance_to(ships[1]) <= 24.0;
+    ASSERT_EQ(within ? 1u : 0u, pairs.size()) << "turn " << turn;
+    if (within) {
+      ASSERT_EQ(pair_of(0, 1, ApproachQueue::Range::Threat), pairs.front());
+    }
+  }
+}
+
+TEST(raf_approach_queue, queue_stays_bounded)
+{
+  const Vec2i dimensions(2000, 100);
+  // Parallel, 30 apart and closing 0.01 a turn, so they only come within
+  // range thousands of turns out. Both are predicted again each time their
+  // horizon runs out.
+  std::vector<Ship> ships = {
+    Ship(0, 0, { 10, 20 }, 0.5, 255),
+    Ship(1, 1, { 10, 50 }, 0.5, 255),
+  };
+  ApproachQueue queue;
+  for (int turn = 0; turn < 500; turn++) {
+    ships[0].update_location(ships[0].current_location() + Vec2d(2, 0.01));
+    ships[1].update_location(ships[1].current_location() + Vec2d(2, 0));
+    HierarchicalGrid<Ship> grid(dimensions);
+    for (const auto& ship : ships) {
+      grid.insert(ship);
+    }
+    queue.begin_frame(turn);
+    for (const auto& ship : ships) {
+      queue.update(ship, grid);
+    }
+    ASSERT_TRUE(due(queue, turn + 1.0).empty()) << "turn " << turn;
+    ASSERT_LE(queue.queued(), 4u) << "turn " << turn;
+  }
+  ASSERT_LT(300u, queue.evaluations());
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(raf_approach_queue, DISABLED_benchmark_against_pairwise)
+{
+  using Clock = std::chrono::steady_clock;
+  const Vec2i dimensions(384, 256);
+  const int turns = 100;
+
+  for (const int count : { 200, 600 }) {
+    std::mt19937 rng(count);
+    std::uniform_real_distribution<double> x(0, dimensions.x());
+    std::uniform_real_distribution<double> y(0, dimensions.y());
+    std::vector<Ship> ships;
+    std::vector<Vec2d> velocities(count);
+    for (EntityId id = 0; id < count; id++) {
+      ships.emplace_back(id, id % 2, Vec2d{ x(rng), y(rng) }, 0.5, 255);
+    }
+
+    ApproachQueue queue;
+    Clock::duration queue_time{}, pairwise_time{};
+    size_t queued = 0, paired = 0;
+    for (int turn = 0; turn < turns; turn++) {
+      advance(ships, velocities, rng);
+      HierarchicalGrid<Ship> grid(dimensions);
+      for (const auto& ship : ships) {
+        grid.insert(ship);
+      }
+
+      auto start = Clock::now();
+      queue.begin_frame(turn);
+      for (const auto& ship : ships) {
+        queue.update(ship, grid);
+      }
+      queue.for_each_due(turn + 1.0, [&queued](const ApproachQueue::Approach&) { queued++; });
+      queue_time += Clock::now() - start;
+
+      start = Clock::now();
+      paired += pairwise(ships).size();
+      pairwise_time += Clock::now() - start;
+    }
+    ASSERT_EQ(paired, queued);
+
+    const auto per_turn = [turns](Clock::duration d) {
+      return std::chrono::duration<double, std::micro>(d).count() / turns;
+    };
+    std::cout << count << " ships: queue " << per_turn(queue_time) << "us/turn ("
+      << queue.evaluations() << " predictions), pairwise " << per_turn(pairwise_time) << "us/turn" << std::endl;
+  }
+}
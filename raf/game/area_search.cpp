@@ -0,0 +1,94 @@
+#include "area_search.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace raf {
+namespace navigation {
+
+constexpr int AreaStats::NUM_DOCKING_STATUSES;
+constexpr int AreaStats::CHANNELS_PER_SIDE;
+constexpr int AreaStats::CHANNELS;
+
+AreaSearch::AreaSearch(const math::Vec2i& dimensions, double cell_size)
+  : cell_size_(cell_size),
+  columns_(std::max(1, static_cast<int>(std::ceil(dimensions.x() / cell_size)))),
+  rows_(std::max(1, static_cast<int>(std::ceil(dimensions.y() / cell_size)))),
+  table_((columns_ + 1) * (rows_ + 1) * AreaStats::CHANNELS, 0) {
+}
+
+void AreaSearch::clear() {
+  std::fill(std::begin(table_), std::end(table_), 0);
+}
+
+void AreaSearch::add(const game::Ship& ship, Side side) {
+  const auto location = ship.current_location();
+  // Bin into the bottom right corner of the cell, integrate() then sums
+  // everything above and to the left of each table position.
+  const auto base = table_index(column(location.x()) + 1, row(location.y()) + 1);
+  table_[base + AreaStats::count_channel(side, ship.docking_status())]++;
+  table_[base + AreaStats::health_channel(side)] += ship.health();
+}
+
+void AreaSearch::integrate() {
+  for (int y = 1; y <= rows_; y++) {
+    for (int x = 1; x <= columns_; x++) {
+      const auto here = table_index(x, y);
+      const auto left = table_index(x - 1, y);
+      const auto up = table_index(x, y - 1);
+      const auto up_left = table_index(x - 1, y - 1);
+      for (int c = 0; c < AreaStats::CHANNELS; c++) {
+        table_[here + c] += table_[left + c] + table_[up + c] - table_[up_left + c];
+      }
+    }
+  }
+}
+
+int AreaSearch::column(double x) const {
+  return std::min(columns_ - 1, std::max(0, static_cast<int>(std::floor(x / cell_size_))));
+}
+
+int AreaSearch::row(double y) const {
+  return std::min(rows_ - 1, std::max(0, static_cast<int>(std::floor(y / cell_size_))));
+}
+
+void AreaSearch::accumulate(int min_x, int min_y, int max_x, int max_y, AreaStats& stats) const {
+  const auto bottom_right = table_index(max_x + 1, max_y + 1);
+  const auto bottom_left = table_index(min_x, max_y + 1);
+  const auto top_right = table_index(max_x + 1, min_y);
+  const auto top_left = table_index(min_x, min_y);
+  for (int c = 0; c < AreaStats::CHANNELS; c++) {
+    stats.values_[c] += table_[bottom_right + c] - table_[bottom_left + c] - table_[top_right + c] + table_[top_left + c];
+  }
+}
+
+AreaStats AreaSearch::in_rect(const math::Vec2d& min, const math::Vec2d& max) const {
+  AreaStats stats;
+  accumulate(column(min.x()), row(min.y()), column(max.x()), row(max.y()), stats);
+  return stats;
+}
+
+AreaStats AreaSearch::in_circle(const math::Vec2d& center, double radius) const {
+  AreaStats stats;
+  // One rectangle per row, as wide as the circle gets anywhere in that row:
+  // at the center for the row holding it, otherwise at the row edge nearer
+  // the center.
+  const int min_y = row(center.y() - radius);
+  const int max_y = row(center.y() + radius);
+  const int center_y = row(center.y());
+  for (int y = min_y; y <= max_y; y++) {
+    double dy = 0.0;
+    if (y < center_y) {
+      dy = center.y() - (y + 1) * cell_size_;
+    } else if (y > center_y) {
+      dy = y * cell_size_ - center.y();
+    }
+    dy = std::min(radius, std::max(0.0, dy));
+    const double half_width = std::sqrt(radius * radius - dy * dy);
+    accumulate(column(center.x() - half_width), y, column(center.x() + half_width), y, stats);
+  }
+  return stats;
+}
+
+}
+}
@@ -0,0 +1,120 @@
+#ifndef RAF_GAME_AREA_SEARCH_H_
+#define RAF_GAME_AREA_SEARCH_H_
+
+#include "ship.hpp"
+#include "../math/math.hpp"
+
+#include <array>
+#include <vector>
+
+namespace raf {
+namespace navigation {
+
+// Default cell size for AreaSearch.
+// Queries are rounded out to whole cells, so this is the precision of a
+// rectangle query. At 4 units a 384x256 map is under 100x70 cells.
+constexpr double DEFAULT_AREA_SEARCH_CELL_SIZE = 4.0;
+
+// Which side of the game a ship is on relative to the local player.
+enum class Side {
+  Friendly = 0,
+  Enemy = 1,
+};
+
+// Totals for the ships in an area.
+class AreaStats {
+public:
+  AreaStats() {
+    values_.fill(0);
+  }
+
+  int ships(Side side) const {
+    int total = 0;
+    for (int status = 0; status < NUM_DOCKING_STATUSES; status++) {
+      total += values_[count_channel(side, static_cast<game::DockingStatus>(status))];
+    }
+    return total;
+  }
+
+  int ships(Side side, game::DockingStatus status) const {
+    return values_[count_channel(side, status)];
+  }
+
+  int health(Side side) const {
+    return values_[health_channel(side)];
+  }
+
+private:
+  friend class AreaSearch;
+
+  static constexpr int NUM_DOCKING_STATUSES = 4;
+  // A count for each docking status plus total health, for each side.
+  static constexpr int CHANNELS_PER_SIDE = NUM_DOCKING_STATUSES + 1;
+  static constexpr int CHANNELS = 2 * CHANNELS_PER_SIDE;
+
+  static int count_channel(Side side, game::DockingStatus status) {
+    return static_cast<int>(side) * CHANNELS_PER_SIDE + static_cast<int>(status);
+  }
+
+  static int health_channel(Side side) {
+    return static_cast<int>(side) * CHANNELS_PER_SIDE + NUM_DOCKING_STATUSES;
+  }
+
+  std::array<int, CHANNELS> values_;
+};
+
+// Returns stats on what is in an area.
+//
+// Ships are binned into a coarse grid once per frame and the grid is turned
+// into a summed-area table, so the totals for any rectangle come from four
+// lookups regardless of how many ships there are.
+//
+// Usage each frame: clear(), add() every ship, then integrate() before
+// querying.
+class AreaSearch {
+public:
+  AreaSearch(const math::Vec2i& dimensions, double cell_size = DEFAULT_AREA_SEARCH_CELL_SIZE);
+
+  void clear();
+  void add(const game::Ship& ship, Side side);
+  // Turn the binned totals into prefix sums. Call after the last add().
+  void integrate();
+
+  // Totals for every cell touched by the rectangle min->max.
+  // Never misses a ship inside the rectangle, but may include ships up to a
+  // cell outside of it.
+  AreaStats in_rect(const math::Vec2d& min, const math::Vec2d& max) const;
+
+  // Totals for the cells touched by a circle, one rectangle per row.
+  // Never misses a ship inside the circle, but may include ships up to a
+  // cell diagonal outside of it. Tighter than in_bounds.
+  AreaStats in_circle(const math::Vec2d& center, double radius) const;
+
+  // Totals for every cell touched by the square bounding the circle.
+  // Never misses a ship inside the circle, use it to rule an area out.
+  AreaStats in_bounds(const math::Vec2d& center, double radius) const {
+    return in_rect(center - math::Vec2d(radius, radius), center + math::Vec2d(radius, radius));
+  }
+
+private:
+  int column(double x) const;
+  int row(double y) const;
+  // Index of the first channel for table position (x, y).
+  // The table has one more row and column than the grid, with zeros along
+  // the top and left edges.
+  int table_index(int x, int y) const {
+    return (y * (columns_ + 1) + x) * AreaStats::CHANNELS;
+  }
+  // Sum for the inclusive cell range.
+  void accumulate(int min_x, int min_y, int max_x, int max_y, AreaStats& stats) const;
+
+  double cell_size_;
+  int columns_;
+  int rows_;
+  std::vector<int> table_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_AREA_SEARCH_H_
@@ -0,0 +1,98 @@
+#include "area_search.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+using raf::game::DockingStatus;
+using raf::game::EntityId;
+using raf::game::Ship;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+using raf::navigation::AreaSearch;
+using raf::navigation::Side;
+
+TEST(raf_area_search, empty)
+{
+  AreaSearch area(Vec2i(240, 160));
+  area.integrate();
+  const auto stats = area.in_rect({ 0, 0 }, { 240, 160 });
+  ASSERT_EQ(0, stats.ships(Side::Friendly));
+  ASSERT_EQ(0, stats.ships(Side::Enemy));
+  ASSERT_EQ(0, stats.health(Side::Enemy));
+}
+
+TEST(raf_area_search, rect_counts_by_side_and_health)
+{
+  AreaSearch area(Vec2i(240, 160));
+  area.add(Ship(0, 0, { 10, 10 }, 0.5, 255), Side::Friendly);
+  area.add(Ship(1, 0, { 30, 30 }, 0.5, 100), Side::Friendly);
+  area.add(Ship(2, 1, { 12, 14 }, 0.5, 64), Side::Enemy);
+  area.add(Ship(3, 1, { 200, 150 }, 0.5, 255), Side::Enemy);
+  area.integrate();
+
+  const auto whole_map = area.in_rect({ 0, 0 }, { 240, 160 });
+  ASSERT_EQ(2, whole_map.ships(Side::Friendly));
+  ASSERT_EQ(2, whole_map.ships(Side::Enemy));
+  ASSERT_EQ(355, whole_map.health(Side::Friendly));
+  ASSERT_EQ(319, whole_map.health(Side::Enemy));
+  ASSERT_EQ(2, whole_map.ships(Side::Enemy, DockingStatus::Undocked));
+  ASSERT_EQ(0, whole_map.ships(Side::Enemy, DockingStatus::Docked));
+
+  const auto corner = area.in_rect({ 8, 8 }, { 16, 16 });
+  ASSERT_EQ(1, corner.ships(Side::Friendly));
+  ASSERT_EQ(1, corner.ships(Side::Enemy));
+  ASSERT_EQ(64, corner.health(Side::Enemy));
+
+  const auto nothing = area.in_rect({ 100, 100 }, { 120, 120 });
+  ASSERT_EQ(0, nothing.ships(Side::Friendly) + nothing.ships(Side::Enemy));
+}
+
+TEST(raf_area_search, bounds_never_miss)
+{
+  const Vec2i dimensions(384, 256);
+  std::vector<Ship> ships;
+  EntityId id = 0;
+  for (double x = 0.5; x < dimensions.x(); x += 9.7) {
+    for (double y = 0.5; y < dimensions.y(); y += 6.3) {
+      ships.emplace_back(id, id % 2, Vec2d{ x, y }, 0.5, 255);
+      id++;
+    }
+  }
+
+  AreaSearch area(dimensions);
+  for (const auto& ship : ships) {
+    area.add(ship, ship.owner() == 0 ? Side::Friendly : Side::Enemy);
+  }
+  area.integrate();
+
+  const Vec2d centers[] = { { 0, 0 }, { 100.5, 37.2 }, { 383.9, 255.9 }, { 200, 128 } };
+  const double radii[] = { 1.0, 7.0, 25.0, 49.0 };
+  for (const auto& center : centers) {
+    for (const auto radius : radii) {
+      // Cells are 4 units, so nothing counted is more than a cell diagonal out.
+      const double slack = 4.0 * std::sqrt(2.0);
+      int inside = 0;
+      int near = 0;
+      for (const auto& ship : ships) {
+        if (ship.distance_to(center) <= radius) {
+          inside++;
+        }
+        if (ship.distance_to(center) <= radius + slack) {
+          near++;
+        }
+      }
+      const auto bounds = area.in_bounds(center, radius);
+      const auto in_bounds = bounds.ships(Side::Friendly) + bounds.ships(Side::Enemy);
+      ASSERT_GE(in_bounds, inside);
+
+      const auto circle = area.in_circle(center, radius);
+      const auto estimate = circle.ships(Side::Friendly) + circle.ships(Side::Enemy);
+      ASSERT_LE(inside, estimate);
+      ASSERT_GE(near, estimate);
+      ASSERT_GE(in_bounds, estimate);
+    }
+  }
+}
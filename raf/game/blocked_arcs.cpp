@@ -0,0 +1,133 @@
+#include "blocked_arcs.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace raf {
+namespace navigation {
+
+// Headings this close to an arc edge are left to the exact test.
+static constexpr double EDGE_MARGIN_RAD = 1e-6;
+// Arcs whose edges are badly conditioned (start almost touching the
+// obstacle, or the end point only just reaching it) are left to the exact
+// test entirely, widened by this much.
+static constexpr double ILL_CONDITIONED_MARGIN_RAD = 2e-3;
+static constexpr double ILL_CONDITIONED_DISTANCE = 1e-3;
+
+static double wrap_angle(double angle_rad) {
+  return std::remainder(angle_rad, 2 * M_PI);
+}
+
+BlockedArcs::BlockedArcs(const math::Vec2d& start, double distance)
+  : start_(start),
+  distance_(distance),
+  // segment_circle_intersect treats very short segments as points.
+  degenerate_(distance * distance < 1e-5) {
+}
+
+void BlockedArcs::add(const math::Vec2d& center, double radius) {
+  if (degenerate_ || center == start_) {
+    return;
+  }
+
+  const auto offset = center - start_;
+  const double d = offset.length();
+  const double bearing = std::atan2(offset.y(), offset.x());
+  const double length = distance_;
+
+  bool ill_conditioned = std::fabs(d - radius) < ILL_CONDITIONED_DISTANCE
+    // objects_between skips obstacles centred on the end point.
+    || std::fabs(d - length) < ILL_CONDITIONED_DISTANCE;
+
+  double half_width;
+  if (d <= radius) {
+    // Starting inside, everything ahead of us is blocked.
+    half_width = M_PI / 2;
+  } else if (std::sqrt(d * d - radius * radius) <= length) {
+    // Tangent point within reach.
+    half_width = std::asin(radius / d);
+  } else {
+    // Only the end point can touch the circle.
+    const double cos_half_width = (d * d + length * length - radius * radius) / (2 * d * length);
+    if (cos_half_width > 1.0) {
+      if (d - length - radius > ILL_CONDITIONED_DISTANCE) {
+        return;
+      }
+      half_width = 0.0;
+      ill_conditioned = true;
+    } else {
+      half_width = std::acos(cos_half_width);
+    }
+  }
+
+  if (ill_conditioned || half_width < ILL_CONDITIONED_MARGIN_RAD) {
+    const double width = half_width + ILL_CONDITIONED_MARGIN_RAD;
+    add_interval(unknown_, bearing - width, bearing + width);
+    return;
+  }
+
+  add_interval(blocked_, bearing - half_width + EDGE_MARGIN_RAD, bearing + half_width - EDGE_MARGIN_RAD);
+  add_interval(unknown_, bearing - half_width - EDGE_MARGIN_RAD, bearing - half_width + EDGE_MARGIN_RAD);
+  add_interval(unknown_, bearing + half_width - EDGE_MARGIN_RAD, bearing + half_width + EDGE_MARGIN_RAD);
+}
+
+void BlockedArcs::merge() {
+  merge_intervals(blocked_);
+  merge_intervals(unknown_);
+}
+
+BlockedArcs::Heading BlockedArcs::classify(double angle_rad) const {
+  if (degenerate_) {
+    return Heading::Unknown;
+  }
+
+  const double angle = wrap_angle(angle_rad);
+  if (contains(unknown_, angle)) {
+    return Heading::Unknown;
+  }
+  return contains(blocked_, angle) ? Heading::Blocked : Heading::Free;
+}
+
+void BlockedArcs::add_interval(std::vector<Interval>& intervals, double from, double to) {
+  if (to - from >= 2 * M_PI) {
+    intervals.push_back({ -M_PI, M_PI });
+    return;
+  }
+
+  const double start = wrap_angle(from);
+  const double end = start + (to - from);
+  if (end > M_PI) {
+    intervals.push_back({ start, M_PI });
+    intervals.push_back({ -M_PI, end - 2 * M_PI });
+  } else {
+    intervals.push_back({ start, end });
+  }
+}
+
+void BlockedArcs::merge_intervals(std::vector<Interval>& intervals) {
+  std::sort(std::begin(intervals), std::end(intervals));
+  std::vector<Interval> merged;
+  for (const auto& interval : intervals) {
+    if (!merged.empty() && interval.first <= merged.back().second) {
+      merged.back().second = std::max(merged.back().second, interval.second);
+    } else {
+      merged.push_back(interval);
+    }
+  }
+  intervals.swap(merged);
+}
+
+bool BlockedArcs::contains(const std::vector<Interval>& intervals, double angle_rad) {
+  // Last interval starting at or before the angle.
+  auto it = std::upper_bound(std::begin(intervals), std::end(intervals), angle_rad, [](double angle, const Interval& i) {
+    return angle < i.first;
+  });
+  if (it == std::begin(intervals)) {
+    return false;
+  }
+  --it;
+  return angle_rad <= it->second;
+}
+
+}
+}
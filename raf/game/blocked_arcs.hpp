@@ -0,0 +1,62 @@
+#ifndef RAF_GAME_BLOCKED_ARCS_H_
+#define RAF_GAME_BLOCKED_ARCS_H_
+
+#include "../math/math.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace navigation {
+
+// Headings blocked by obstacles for a straight move of fixed length.
+//
+// A circular obstacle blocks a single arc of headings centred on the bearing
+// to it. The arc's half width comes from either the tangent to the circle or,
+// when the tangent point is out of reach, the move's end point touching it.
+// Arcs from every obstacle are merged once, after which classifying a
+// heading is a binary search instead of a segment test per obstacle.
+//
+// Arc edges are computed analytically while collision::segment_circle_intersect
+// is evaluated numerically, so headings within a small margin of an edge are
+// reported as Unknown and should be confirmed with the exact test.
+class BlockedArcs {
+public:
+  enum class Heading {
+    Free,
+    Blocked,
+    Unknown,
+  };
+
+  BlockedArcs(const math::Vec2d& start, double distance);
+
+  // Add a circular obstacle, radius should include any fudge factor.
+  // Obstacles centred on start are ignored, as objects_between does.
+  void add(const math::Vec2d& center, double radius);
+
+  // Sort and merge arcs. Call once after the last add().
+  void merge();
+
+  Heading classify(double angle_rad) const;
+
+private:
+  using Interval = std::pair<double, double>;
+
+  // Add [from, to] to intervals, splitting it where it wraps around +/-pi.
+  static void add_interval(std::vector<Interval>& intervals, double from, double to);
+  static void merge_intervals(std::vector<Interval>& intervals);
+  static bool contains(const std::vector<Interval>& intervals, double angle_rad);
+
+  math::Vec2d start_;
+  double distance_;
+  // Too short for the analytic arcs to match the exact test.
+  bool degenerate_;
+  // Sorted, non overlapping, within [-pi, pi].
+  std::vector<Interval> blocked_;
+  std::vector<Interval> unknown_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_BLOCKED_ARCS_H_
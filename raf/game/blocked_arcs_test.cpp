@@ -0,0 +1,106 @@
+#include "blocked_arcs.hpp"
+#include "collision.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using raf::collision::segment_circle_intersect;
+using raf::math::Vec2d;
+using raf::navigation::BlockedArcs;
+
+struct Circle {
+  Vec2d center;
+  double radius;
+};
+
+static Vec2d end_point(const Vec2d& start, double angle_rad, double distance) {
+  return { start.x() + std::cos(angle_rad) * distance, start.y() + std::sin(angle_rad) * distance };
+}
+
+TEST(raf_blocked_arcs, nothing_blocked)
+{
+  BlockedArcs arcs({ 10, 10 }, 7);
+  arcs.merge();
+  ASSERT_EQ(BlockedArcs::Heading::Free, arcs.classify(0.3));
+}
+
+TEST(raf_blocked_arcs, obstacle_ahead)
+{
+  BlockedArcs arcs({ 0, 0 }, 20);
+  arcs.add({ 10, 0 }, 2);
+  arcs.merge();
+
+  ASSERT_EQ(BlockedArcs::Heading::Blocked, arcs.classify(0));
+  ASSERT_EQ(BlockedArcs::Heading::Blocked, arcs.classify(2 * M_PI));
+  // Tangent half width is asin(2 / 10), about 11.5 degrees.
+  ASSERT_EQ(BlockedArcs::Heading::Blocked, arcs.classify(raf::math::degrees_to_rads(11)));
+  ASSERT_EQ(BlockedArcs::Heading::Free, arcs.classify(raf::math::degrees_to_rads(12)));
+  ASSERT_EQ(BlockedArcs::Heading::Free, arcs.classify(M_PI));
+}
+
+TEST(raf_blocked_arcs, out_of_reach)
+{
+  BlockedArcs arcs({ 0, 0 }, 7);
+  arcs.add({ 10, 0 }, 2);
+  arcs.merge();
+  ASSERT_EQ(BlockedArcs::Heading::Free, arcs.classify(0));
+}
+
+TEST(raf_blocked_arcs, wraps_around_pi)
+{
+  BlockedArcs arcs({ 0, 0 }, 20);
+  arcs.add({ -10, 0.5 }, 2);
+  arcs.merge();
+  ASSERT_EQ(BlockedArcs::Heading::Blocked, arcs.classify(M_PI));
+  ASSERT_EQ(BlockedArcs::Heading::Blocked, arcs.classify(-M_PI + 0.05));
+  ASSERT_EQ(BlockedArcs::Heading::Free, arcs.classify(0));
+}
+
+TEST(raf_blocked_arcs, agrees_with_segment_test)
+{
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<double> coordinate(-30, 30);
+  std::uniform_real_distribution<double> radius(0.5, 8);
+  std::uniform_real_distribution<double> distance(0.5, 40);
+  std::uniform_real_distribution<double> angle(-4 * M_PI, 4 * M_PI);
+  const double fudge = 0.6;
+
+  int unknown = 0;
+  int total = 0;
+  for (int scene = 0; scene < 300; scene++) {
+    const Vec2d start(coordinate(rng), coordinate(rng));
+    const double length = distance(rng);
+    std::vector<Circle> circles;
+    for (int i = 0; i < 12; i++) {
+      circles.push_back({ { coordinate(rng), coordinate(rng) }, radius(rng) });
+    }
+
+    BlockedArcs arcs(start, length);
+    for (const auto& c : circles) {
+      arcs.add(c.center, c.radius + fudge);
+    }
+    arcs.merge();
+
+    for (int i = 0; i < 200; i++) {
+      const double heading = angle(rng);
+      const auto end = end_point(start, heading, length);
+      bool blocked = false;
+      for (const auto& c : circles) {
+        blocked = blocked || segment_circle_intersect(start, end, c.center, fudge, c.radius);
+      }
+
+      const auto result = arcs.classify(heading);
+      total++;
+      if (result == BlockedArcs::Heading::Unknown) {
+        unknown++;
+      } else {
+        ASSERT_EQ(blocked, result == BlockedArcs::Heading::Blocked) << "scene " << scene << " heading " << heading;
+      }
+    }
+  }
+  // Unknown headings fall back to the exact test, they should be rare.
+  ASSERT_LT(unknown, total / 100);
+}
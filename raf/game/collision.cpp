@@ -1,5 +1,14 @@
 #include "collision.hpp"
 #include <algorithm>
+#include <cmath>
+
+#if !defined(RAF_NO_SIMD) && defined(__AVX2__)
+#define RAF_COLLISION_AVX2
+#include <immintrin.h>
+#elif !defined(RAF_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RAF_COLLISION_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace raf {
 namespace collision {
@@ -47,5 +56,210 @@ bool segment_circle_intersect(const Vec2d & start, const Vec2d & end, const Vec2
   return closest_distance <= circle_radius + fudge;
 }
 
+// Terms of segment_circle_intersect that only depend on the segment.
+struct Segment {
+  Segment(const Vec2d& start, const Vec2d& end)
+    : sx(start.x()),
+    sy(start.y()),
+    ex(end.x()),
+    ey(end.y()),
+    dx((end - start).x()),
+    dy((end - start).y()),
+    a((end - start).length_squared()),
+    b_prefix(square(start.x()) - (start.x() * end.x())),
+    sy_sy(square(start.y())),
+    sy_ey(start.y() * end.y()),
+    degenerate(std::fabs(a) < 0.000001) {
+  }
+
+  double sx, sy, ex, ey;
+  double dx, dy;
+  double a;
+  // First two terms of b, in the same order segment_circle_intersect adds them.
+  double b_prefix;
+  double sy_sy;
+  double sy_ey;
+  bool degenerate;
+};
+
+// Must mirror segment_circle_intersect operation for operation.
+static bool segment_hits(const Segment& s, double ox, double oy, double radius, double fudge) {
+  if (s.degenerate) {
+    const double fx = s.sx - ox;
+    const double fy = s.sy - oy;
+    return std::sqrt(fx * fx + fy * fy) <= radius + fudge;
+  }
+
+  double sum = s.b_prefix;
+  sum = sum - (s.sx * ox);
+  sum = sum + (s.ex * ox);
+  sum = sum + s.sy_sy;
+  sum = sum - s.sy_ey;
+  sum = sum - (s.sy * oy);
+  sum = sum + (s.ey * oy);
+  const double b = -2 * sum;
+
+  const double t = std::min(-b / (2 * s.a), 1.0);
+  if (t < 0) {
+    return false;
+  }
+
+  const double cx = s.sx + s.dx * t;
+  const double cy = s.sy + s.dy * t;
+  const double ddx = cx - ox;
+  const double ddy = cy - oy;
+  return std::sqrt(ddx * ddx + ddy * ddy) <= radius + fudge;
+}
+
+#if defined(RAF_COLLISION_AVX2)
+static constexpr int LANES = 4;
+
+// Bit i of the result is set if circle i of the block is hit.
+static int segment_hits_block(const Segment& s, const double* x, const double* y, const double* r, double fudge) {
+  const __m256d ox = _mm256_loadu_pd(x);
+  const __m256d oy = _mm256_loadu_pd(y);
+  const __m256d sx = _mm256_set1_pd(s.sx);
+  const __m256d sy = _mm256_set1_pd(s.sy);
+
+  __m256d sum = _mm256_set1_pd(s.b_prefix);
+  sum = _mm256_sub_pd(sum, _mm256_mul_pd(sx, ox));
+  sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_set1_pd(s.ex), ox));
+  sum = _mm256_add_pd(sum, _mm256_set1_pd(s.sy_sy));
+  sum = _mm256_sub_pd(sum, _mm256_set1_pd(s.sy_ey));
+  sum = _mm256_sub_pd(sum, _mm256_mul_pd(sy, oy));
+  sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_set1_pd(s.ey), oy));
+  const __m256d b = _mm256_mul_pd(_mm256_set1_pd(-2.0), sum);
+
+  // -b is a sign flip, std::min(t, 1.0) is (1.0 < t) ? 1.0 : t.
+  const __m256d one = _mm256_set1_pd(1.0);
+  __m256d t = _mm256_div_pd(_mm256_xor_pd(b, _mm256_set1_pd(-0.0)), _mm256_set1_pd(2 * s.a));
+  t = _mm256_blendv_pd(t, one, _mm256_cmp_pd(one, t, _CMP_LT_OQ));
+  const __m256d ahead = _mm256_cmp_pd(t, _mm256_setzero_pd(), _CMP_NLT_UQ);
+
+  const __m256d ddx = _mm256_sub_pd(_mm256_add_pd(sx, _mm256_mul_pd(_mm256_set1_pd(s.dx), t)), ox);
+  const __m256d ddy = _mm256_sub_pd(_mm256_add_pd(sy, _mm256_mul_pd(_mm256_set1_pd(s.dy), t)), oy);
+  const __m256d distance = _mm256_sqrt_pd(_mm256_add_pd(_mm256_mul_pd(ddx, ddx), _mm256_mul_pd(ddy, ddy)));
+  const __m256d limit = _mm256_add_pd(_mm256_loadu_pd(r), _mm256_set1_pd(fudge));
+  const __m256d hit = _mm256_and_pd(ahead, _mm256_cmp_pd(distance, limit, _CMP_LE_OQ));
+  return _mm256_movemask_pd(hit);
+}
+#elif defined(RAF_COLLISION_SSE2)
+static constexpr int LANES = 2;
+
+// Bit i of the result is set if circle i of the block is hit.
+static int segment_hits_block(const Segment& s, const double* x, const double* y, const double* r, double fudge) {
+  const __m128d ox = _mm_loadu_pd(x);
+  const __m128d oy = _mm_loadu_pd(y);
+  const __m128d sx = _mm_set1_pd(s.sx);
+  const __m128d sy = _mm_set1_pd(s.sy);
+
+  __m128d sum = _mm_set1_pd(s.b_prefix);
+  sum = _mm_sub_pd(sum, _mm_mul_pd(sx, ox));
+  sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(s.ex), ox));
+  sum = _mm_add_pd(sum, _mm_set1_pd(s.sy_sy));
+  sum = _mm_sub_pd(sum, _mm_set1_pd(s.sy_ey));
+  sum = _mm_sub_pd(sum, _mm_mul_pd(sy, oy));
+  sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set1_pd(s.ey), oy));
+  const __m128d b = _mm_mul_pd(_mm_set1_pd(-2.0), sum);
+
+  // -b is a sign flip, std::min(t, 1.0) is (1.0 < t) ? 1.0 : t.
+  const __m128d one = _mm_set1_pd(1.0);
+  __m128d t = _mm_div_pd(_mm_xor_pd(b, _mm_set1_pd(-0.0)), _mm_set1_pd(2 * s.a));
+  const __m128d clamp = _mm_cmplt_pd(one, t);
+  t = _mm_or_pd(_mm_and_pd(clamp, one), _mm_andnot_pd(clamp, t));
+  const __m128d ahead = _mm_cmpnlt_pd(t, _mm_setzero_pd());
+
+  const __m128d ddx = _mm_sub_pd(_mm_add_pd(sx, _mm_mul_pd(_mm_set1_pd(s.dx), t)), ox);
+  const __m128d ddy = _mm_sub_pd(_mm_add_pd(sy, _mm_mul_pd(_mm_set1_pd(s.dy), t)), oy);
+  const __m128d distance = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(ddx, ddx), _mm_mul_pd(ddy, ddy)));
+  const __m128d limit = _mm_add_pd(_mm_loadu_pd(r), _mm_set1_pd(fudge));
+  const __m128d hit = _mm_and_pd(ahead, _mm_cmple_pd(distance, limit));
+  return _mm_movemask_pd(hit);
+}
+#endif
+
+void segment_circles_intersect_scalar(
+  const Vec2d& start,
+  const Vec2d& end,
+  const CircleSet& circles,
+  const double fudge,
+  std::vector<unsigned char>& hits)
+{
+  const Segment segment(start, end);
+  const int n = static_cast<int>(circles.size());
+  hits.resize(n);
+  for (int i = 0; i < n; i++) {
+    hits[i] = segment_hits(segment, circles.x[i], circles.y[i], circles.radius[i], fudge);
+  }
+}
+
+void segment_circles_intersect(
+  const Vec2d& start,
+  const Vec2d& end,
+  const CircleSet& circles,
+  const double fudge,
+  std::vector<unsigned char>& hits)
+{
+#if defined(RAF_COLLISION_AVX2) || defined(RAF_COLLISION_SSE2)
+  const Segment segment(start, end);
+  const int n = static_cast<int>(circles.size());
+  hits.resize(n);
+  int i = 0;
+  if (!segment.degenerate) {
+    for (; i + LANES <= n; i += LANES) {
+      const int mask = segment_hits_block(segment, &circles.x[i], &circles.y[i], &circles.radius[i], fudge);
+      for (int lane = 0; lane < LANES; lane++) {
+        hits[i + lane] = (mask >> lane) & 1;
+      }
+    }
+  }
+  for (; i < n; i++) {
+    hits[i] = segment_hits(segment, circles.x[i], circles.y[i], circles.radius[i], fudge);
+  }
+#else
+  segment_circles_intersect_scalar(start, end, circles, fudge, hits);
+#endif
+}
+
+int first_segment_circle_hit(
+  const Vec2d& start,
+  const Vec2d& end,
+  const CircleSet& circles,
+  const double fudge,
+  int from)
+{
+  const Segment segment(start, end);
+  const int n = static_cast<int>(circles.size());
+  int i = std::max(0, from);
+#if defined(RAF_COLLISION_AVX2) || defined(RAF_COLLISION_SSE2)
+  if (!segment.degenerate) {
+    for (; i + LANES <= n; i += LANES) {
+      const int mask = segment_hits_block(segment, &circles.x[i], &circles.y[i], &circles.radius[i], fudge);
+      for (int lane = 0; lane < LANES; lane++) {
+        if ((mask >> lane) & 1) {
+          return i + lane;
+        }
+      }
+    }
+  }
+#endif
+  for (; i < n; i++) {
+    if (segment_hits(segment, circles.x[i], circles.y[i], circles.radius[i], fudge)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const char* segment_circles_kernel() {
+#if defined(RAF_COLLISION_AVX2)
+  return "avx2";
+#elif defined(RAF_COLLISION_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
 } // namespace collision
 } // namespace raf
@@ -2,6 +2,7 @@
 #define RAF_GAME_COLLISION_H_
 
 #include <algorithm>
+#include <vector>
 
 #include "../math/math.hpp"
 
@@ -28,6 +29,73 @@ namespace collision {
     const double fudge,
     const double circle_radius);
 
+  // Circles in structure-of-arrays form, for testing one segment against many
+  // circles at once.
+  struct CircleSet {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> radius;
+
+    void clear() {
+      x.clear();
+      y.clear();
+      radius.clear();
+    }
+
+    void reserve(size_t n) {
+      x.reserve(n);
+      y.reserve(n);
+      radius.reserve(n);
+    }
+
+    void push_back(const Vec2d& center, double r) {
+      x.push_back(center.x());
+      y.push_back(center.y());
+      radius.push_back(r);
+    }
+
+    size_t size() const { return x.size(); }
+  };
+
+  /**
+    * Batched segment_circle_intersect against every circle in a set.
+    *
+    * Uses AVX2 or SSE2 when the build targets them (define RAF_NO_SIMD to
+    * force the scalar code). Every path performs the same IEEE operations in
+    * the same order as segment_circle_intersect, so results are bit for bit
+    * identical as long as the compiler is not allowed to fuse multiply-adds.
+    *
+    * @param hits   Resized to circles.size(), hits[i] is 1 if circle i is hit, else 0.
+    */
+  void segment_circles_intersect(
+    const Vec2d& start,
+    const Vec2d& end,
+    const CircleSet& circles,
+    const double fudge,
+    std::vector<unsigned char>& hits);
+
+  /**
+    * Index of the first circle at or after from that the segment hits, or -1.
+    */
+  int first_segment_circle_hit(
+    const Vec2d& start,
+    const Vec2d& end,
+    const CircleSet& circles,
+    const double fudge,
+    int from = 0);
+
+  // Portable version of segment_circles_intersect, always compiled so the
+  // vector paths can be tested against it.
+  void segment_circles_intersect_scalar(
+    const Vec2d& start,
+    const Vec2d& end,
+    const CircleSet& circles,
+    const double fudge,
+    std::vector<unsigned char>& hits);
+
+  // Name of the batched kernel chosen at build time: "avx2", "sse2" or "scalar".
+  const char* segment_circles_kernel();
+
 }
 }
 
@@ -5,6 +5,8 @@
 #include "ship.hpp"
 #include "gtest/gtest.h"
 
+#include <cmath>
+#include <random>
 #include <vector>
 
 using raf::game::Planet;
@@ -57,3 +59,75 @@ TEST(raf_collision, failed_in_deployment)
     EXPECT_EQ(false, intersect);
   }
 }
+
+// Random segments against random circles, plus circles placed exactly on the
+// boundary of the fudge zone where rounding decides the result.
+static void check_batch_matches_scalar(const raf::math::Vec2d& start, const raf::math::Vec2d& end, std::mt19937& rng)
+{
+  std::uniform_real_distribution<double> coordinate(-20, 60);
+  std::uniform_real_distribution<double> radius(0.5, 12);
+  const double fudge = raf::constants::FORECAST_FUDGE_FACTOR;
+
+  raf::collision::CircleSet circles;
+  for (int i = 0; i < 37; i++) {
+    circles.push_back({ coordinate(rng), coordinate(rng) }, radius(rng));
+  }
+  // Exactly touching the end point, and centred on the start.
+  circles.push_back(end + raf::math::Vec2d(0, 0.5 + fudge), 0.5);
+  circles.push_back(start, 0.5);
+
+  std::vector<unsigned char> batch;
+  std::vector<unsigned char> scalar;
+  raf::collision::segment_circles_intersect(start, end, circles, fudge, batch);
+  raf::collision::segment_circles_intersect_scalar(start, end, circles, fudge, scalar);
+  ASSERT_EQ(circles.size(), batch.size());
+
+  int first = -1;
+  for (size_t i = 0; i < circles.size(); i++) {
+    const bool expected = raf::collision::segment_circle_intersect(
+      start, end, { circles.x[i], circles.y[i] }, fudge, circles.radius[i]);
+    ASSERT_EQ(expected, batch[i] != 0) << "circle " << i;
+    ASSERT_EQ(expected, scalar[i] != 0) << "circle " << i;
+    if (expected && first < 0) {
+      first = static_cast<int>(i);
+    }
+  }
+  ASSERT_EQ(first, raf::collision::first_segment_circle_hit(start, end, circles, fudge));
+}
+
+TEST(raf_collision, batch_matches_scalar)
+{
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<double> coordinate(0, 40);
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  std::uniform_real_distribution<double> length(0, 20);
+  for (int i = 0; i < 2000; i++) {
+    const raf::math::Vec2d start(coordinate(rng), coordinate(rng));
+    const double a = angle(rng);
+    const double l = length(rng);
+    check_batch_matches_scalar(start, start + raf::math::Vec2d(l * std::cos(a), l * std::sin(a)), rng);
+  }
+}
+
+TEST(raf_collision, batch_degenerate_segment)
+{
+  std::mt19937 rng(4);
+  const raf::math::Vec2d start(10, 10);
+  check_batch_matches_scalar(start, start, rng);
+  check_batch_matches_scalar(start, start + raf::math::Vec2d(0.0001, 0), rng);
+}
+
+TEST(raf_collision, batch_first_hit_from)
+{
+  raf::collision::CircleSet circles;
+  for (int i = 0; i < 9; i++) {
+    circles.push_back({ 5.0 + i * 10, 0 }, 1);
+  }
+  const raf::math::Vec2d start(0, 0);
+  const raf::math::Vec2d end(100, 0);
+  ASSERT_EQ(0, raf::collision::first_segment_circle_hit(start, end, circles, 0.6));
+  ASSERT_EQ(3, raf::collision::first_segment_circle_hit(start, end, circles, 0.6, 3));
+  ASSERT_EQ(8, raf::collision::first_segment_circle_hit(start, end, circles, 0.6, 8));
+  ASSERT_EQ(-1, raf::collision::first_segment_circle_hit(start, end, circles, 0.6, 9));
+  ASSERT_EQ(-1, raf::collision::first_segment_circle_hit(start, { 0, 100 }, circles, 0.6));
+}
@@ -0,0 +1,217 @@
+#include "distance_cache.hpp"
+#include "../math/vec2x4.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace raf {
+namespace game {
+
+using math::Double4;
+using math::Vec2x4;
+
+static size_t padded(size_t count) {
+  return (count + Double4::LANES - 1) / Double4::LANES * Double4::LANES;
+}
+
+static void index_ids(const std::vector<EntityId>& ids, std::vector<int>& slot_of, int invalid) {
+  EntityId max_id = -1;
+  for (const auto id : ids) {
+    max_id = std::max(max_id, id);
+  }
+  slot_of.assign(max_id + 1, invalid);
+  for (size_t i = 0; i < ids.size(); i++) {
+    slot_of[ids[i]] = static_cast<int>(i);
+  }
+}
+
+constexpr int DistanceCache::INVALID_SLOT;
+
+DistanceCache::DistanceCache(const math::Vec2i& dimensions, size_t dense_limit)
+  : dimensions_(dimensions),
+  dense_limit_(dense_limit) {
+  for (auto* table : { &ships_, &planets_ }) {
+    table->columns = 0;
+    table->dense = true;
+    table->stride = 0;
+  }
+}
+
+void DistanceCache::build(const EntityStore<Ship>& friendly, const EntityStore<Ship>& enemy, const EntityStore<Planet>& planets) {
+  const auto& rows = friendly.columns();
+  index_ids(rows.id, row_of_, INVALID_SLOT);
+  row_x_ = rows.x;
+  row_y_ = rows.y;
+  row_radius_ = rows.radius;
+
+  build_table(ships_, enemy.columns());
+  build_table(planets_, planets.columns());
+}
+
+void DistanceCache::build_table(Table& table, const EntityColumns& others) const {
+  index_ids(others.id, table.column_of, INVALID_SLOT);
+  table.columns = others.size();
+  table.ids = others.id;
+  // Padding lanes sit at the origin, their results are never read.
+  const auto size = padded(table.columns);
+  table.xs.assign(size, 0.0);
+  table.ys.assign(size, 0.0);
+  table.radii.assign(size, 0.0);
+  std::copy(std::begin(others.x), std::end(others.x), std::begin(table.xs));
+  std::copy(std::begin(others.y), std::end(others.y), std::begin(table.ys));
+  std::copy(std::begin(others.radius), std::end(others.radius), std::begin(table.radii));
+
+  table.dense = row_x_.size() * table.columns <= dense_limit_;
+  if (table.dense) {
+    fill_dense(table);
+  } else {
+    fill_sparse(table);
+  }
+}
+
+void DistanceCache::fill_dense(Table& table) const {
+  const auto rows = row_x_.size();
+  table.stride = table.xs.size();
+  table.row_start.clear();
+  table.kept_column.clear();
+  table.center.resize(rows * table.stride);
+  table.edge.resize(rows * table.stride);
+
+  for (size_t row = 0; row < rows; row++) {
+    const auto location = Vec2x4::broadcast({ row_x_[row], row_y_[row] });
+    const auto radius = Double4::broadcast(row_radius_[row]);
+    auto* center = &table.center[row * table.stride];
+    auto* edge = &table.edge[row * table.stride];
+    for (size_t column = 0; column < table.stride; column += Double4::LANES) {
+      // As Entity::distance_to and distance_to_edge compute them.
+      const auto delta = location - Vec2x4::load(&table.xs[column], &table.ys[column]);
+      const auto length = sqrt(dot_product(delta, delta));
+      length.store(center + column);
+      ((length - Double4::load(&table.radii[column])) - radius).store(edge + column);
+    }
+  }
+}
+
+void DistanceCache::fill_sparse(Table& table) const {
+  // Renumber the columns cell by cell, then each row only looks at the runs
+  // of columns in the cells around it.
+  const double cell_size = DISTANCE_CACHE_SPARSE_RANGE;
+  const int grid_columns = std::max(1, static_cast<int>(std::ceil(dimensions_.x() / cell_size)));
+  const int grid_rows = std::max(1, static_cast<int>(std::ceil(dimensions_.y() / cell_size)));
+  const auto cell_of = [&](double x, double y) {
+    const auto cx = std::min(grid_columns - 1, std::max(0, static_cast<int>(x / cell_size)));
+    const auto cy = std::min(grid_rows - 1, std::max(0, static_cast<int>(y / cell_size)));
+    return cy * grid_columns + cx;
+  };
+
+  std::vector<size_t> cell_start(grid_columns * grid_rows + 1, 0);
+  std::vector<int> cells(table.columns);
+  for (size_t column = 0; column < table.columns; column++) {
+    cells[column] = cell_of(table.xs[column], table.ys[column]);
+    cell_start[cells[column] + 1]++;
+  }
+  for (size_t cell = 1; cell < cell_start.size(); cell++) {
+    cell_start[cell] += cell_start[cell - 1];
+  }
+  auto next = cell_start;
+  std::vector<EntityId> ids(table.columns);
+  std::vector<double> xs(table.columns), ys(table.columns), radii(table.columns);
+  for (auto& column : table.column_of) {
+    if (column == INVALID_SLOT) {
+      continue;
+    }
+    const auto renumbered = next[cells[column]]++;
+    ids[renumbered] = table.ids[column];
+    xs[renumbered] = table.xs[column];
+    ys[renumbered] = table.ys[column];
+    radii[renumbered] = table.radii[column];
+    column = static_cast<int>(renumbered);
+  }
+  table.ids = std::move(ids);
+  table.xs = std::move(xs);
+  table.ys = std::move(ys);
+  table.radii = std::move(radii);
+
+  const auto rows = row_x_.size();
+  table.stride = 0;
+  table.row_start.assign(1, 0);
+  table.kept_column.clear();
+  table.center.clear();
+  table.edge.clear();
+  for (size_t row = 0; row < rows; row++) {
+    const auto cell = cell_of(row_x_[row], row_y_[row]);
+    const auto cx = cell % grid_columns;
+    const auto cy = cell / grid_columns;
+    const auto left = std::max(0, cx - 1);
+    const auto right = std::min(grid_columns - 1, cx + 1);
+    for (int y = std::max(0, cy - 1); y <= std::min(grid_rows - 1, cy + 1); y++) {
+      const auto first = cell_start[y * grid_columns + left];
+      const auto last = cell_start[y * grid_columns + right + 1];
+      for (auto column = first; column < last; column++) {
+        const auto distances = compute(table, static_cast<int>(row), static_cast<int>(column));
+        if (distances.center <= DISTANCE_CACHE_SPARSE_RANGE) {
+          table.kept_column.push_back(static_cast<int>(column));
+          table.center.push_back(distances.center);
+          table.edge.push_back(distances.edge);
+        }
+      }
+    }
+    table.row_start.push_back(table.kept_column.size());
+  }
+}
+
+void DistanceCache::throw_missing(EntityId id) {
+  throw std::out_of_range("DistanceCache: no entity " + std::to_string(id));
+}
+
+DistanceCache::Distances DistanceCache::lookup_sparse(const Table& table, int row, int column) const {
+  const auto first = std::begin(table.kept_column) + table.row_start[row];
+  const auto last = std::begin(table.kept_column) + table.row_start[row + 1];
+  const auto found = std::lower_bound(first, last, column);
+  if (found != last && *found == column) {
+    const auto entry = found - std::begin(table.kept_column);
+    return { table.center[entry], table.edge[entry] };
+  }
+  return compute(table, row, column);
+}
+
+EntityId DistanceCache::nearest(const Table& table, EntityId friendly) const {
+  const auto row = slot(row_of_, friendly);
+  int best = INVALID_SLOT;
+  double best_distance = 0.0;
+  const auto consider = [&](int column, double distance) {
+    if (best == INVALID_SLOT || distance < best_distance
+      || (distance == best_distance && table.ids[column] < table.ids[best])) {
+      best = column;
+      best_distance = distance;
+    }
+  };
+
+  if (table.dense) {
+    const auto* center = &table.center[row * table.stride];
+    for (size_t column = 0; column < table.columns; column++) {
+      consider(static_cast<int>(column), center[column]);
+    }
+  } else {
+    // Everything within range is kept, so only an empty row needs the rest.
+    for (auto entry = table.row_start[row]; entry < table.row_start[row + 1]; entry++) {
+      consider(table.kept_column[entry], table.center[entry]);
+    }
+    if (best == INVALID_SLOT) {
+      for (size_t column = 0; column < table.columns; column++) {
+        consider(static_cast<int>(column), compute(table, row, static_cast<int>(column)).center);
+      }
+    }
+  }
+  return best == INVALID_SLOT ? INVALID_ENTITIY_ID : table.ids[best];
+}
+
+DistanceCache::Distances DistanceCache::compute(const Table& table, int row, int column) const {
+  const auto center = (math::Vec2d(row_x_[row], row_y_[row]) - math::Vec2d(table.xs[column], table.ys[column])).length();
+  return { center, center - table.radii[column] - row_radius_[row] };
+}
+
+}
+}
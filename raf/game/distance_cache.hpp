@@ -0,0 +1,160 @@
+#ifndef RAF_GAME_DISTANCE_CACHE_H_
+#define RAF_GAME_DISTANCE_CACHE_H_
+
+#include "constants.hpp"
+#include "entity.hpp"
+#include "entity_store.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "../math/math.hpp"
+
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Largest friendly x other table kept dense, in entries, 4MB of doubles.
+// Above it only pairs within DISTANCE_CACHE_SPARSE_RANGE are kept.
+constexpr size_t DISTANCE_CACHE_DENSE_LIMIT = 1 << 18;
+
+// Centre distance within which the sparse form keeps a pair. Wide enough
+// for the 13 turn target search.
+constexpr double DISTANCE_CACHE_SPARSE_RANGE = 100.0;
+
+// Distances from each of our ships to every enemy ship and every planet,
+// built once per frame in pre_frame().
+//
+// Each table holds a row per friendly ship in two contiguous arrays, centre
+// and edge distance, filled four columns at a time. Results are the
+// same expressions as the Entity methods, bit for bit, so a lookup can stand
+// in for a call anywhere.
+//
+// When a table would exceed the dense limit it only keeps pairs the ship grid
+// would find within the sparse range. Anything else is worked out on demand,
+// so lookups give the same answer in either form.
+class DistanceCache {
+public:
+  DistanceCache(const math::Vec2i& dimensions, size_t dense_limit = DISTANCE_CACHE_DENSE_LIMIT);
+
+  void build(const EntityStore<Ship>& friendly, const EntityStore<Ship>& enemy, const EntityStore<Planet>& planets);
+
+  // Whether the enemy and planet tables are held in full.
+  bool is_ship_table_dense() const { return ships_.dense; }
+  bool is_planet_table_dense() const { return planets_.dense; }
+
+  // Same as friendly.distance_to(enemy), and so on for the rest. Ids must be
+  // of ships and planets given to build(), otherwise std::out_of_range is
+  // thrown.
+  double ship_distance(EntityId friendly, EntityId enemy) const {
+    return lookup(ships_, friendly, enemy).center;
+  }
+
+  double ship_edge_distance(EntityId friendly, EntityId enemy) const {
+    return lookup(ships_, friendly, enemy).edge;
+  }
+
+  double ship_turns(EntityId friendly, EntityId enemy) const {
+    return (ship_distance(friendly, enemy) / constants::MAX_SPEED) + 1;
+  }
+
+  double ship_edge_turns(EntityId friendly, EntityId enemy) const {
+    return (ship_edge_distance(friendly, enemy) / constants::MAX_SPEED) + 1;
+  }
+
+  double planet_distance(EntityId friendly, EntityId planet) const {
+    return lookup(planets_, friendly, planet).center;
+  }
+
+  double planet_edge_distance(EntityId friendly, EntityId planet) const {
+    return lookup(planets_, friendly, planet).edge;
+  }
+
+  double planet_turns(EntityId friendly, EntityId planet) const {
+    return (planet_distance(friendly, planet) / constants::MAX_SPEED) + 1;
+  }
+
+  double planet_edge_turns(EntityId friendly, EntityId planet) const {
+    return (planet_edge_distance(friendly, planet) / constants::MAX_SPEED) + 1;
+  }
+
+  // Nearest enemy ship or planet to one of our ships by centre distance,
+  // the lowest id on a tie. INVALID_ENTITIY_ID if there are none.
+  EntityId nearest_ship(EntityId friendly) const { return nearest(ships_, friendly); }
+  EntityId nearest_planet(EntityId friendly) const { return nearest(planets_, friendly); }
+
+private:
+  struct Distances {
+    double center;
+    double edge;
+  };
+
+  // Distances from every friendly ship to one kind of entity.
+  struct Table {
+    // By id, INVALID_SLOT if not in the table.
+    std::vector<int> column_of;
+    // By column.
+    std::vector<EntityId> ids;
+    // By column, padded to a whole number of lanes.
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> radii;
+    size_t columns;
+    bool dense;
+
+    // Dense, rows x stride. Sparse, the kept entries of each row, ordered
+    // by column, from row_start[row] to row_start[row + 1]. Sparse columns
+    // are numbered cell by cell, so each row's candidates are a few runs of
+    // consecutive columns.
+    size_t stride;
+    std::vector<size_t> row_start;
+    std::vector<int> kept_column;
+    std::vector<double> center;
+    std::vector<double> edge;
+  };
+
+  static constexpr int INVALID_SLOT = -1;
+
+  void build_table(Table& table, const EntityColumns& others) const;
+  void fill_dense(Table& table) const;
+  void fill_sparse(Table& table) const;
+
+  Distances lookup(const Table& table, EntityId friendly, EntityId other) const {
+    const auto row = slot(row_of_, friendly);
+    const auto column = slot(table.column_of, other);
+    if (table.dense) {
+      const auto cell = row * table.stride + column;
+      return { table.center[cell], table.edge[cell] };
+    }
+    return lookup_sparse(table, row, column);
+  }
+
+  static int slot(const std::vector<int>& slots, EntityId id) {
+    if (id < 0 || id >= static_cast<EntityId>(slots.size()) || slots[id] == INVALID_SLOT) {
+      throw_missing(id);
+    }
+    return slots[id];
+  }
+
+  // Throws std::out_of_range.
+  static void throw_missing(EntityId id);
+  Distances lookup_sparse(const Table& table, int row, int column) const;
+  EntityId nearest(const Table& table, EntityId friendly) const;
+  Distances compute(const Table& table, int row, int column) const;
+
+  math::Vec2i dimensions_;
+  size_t dense_limit_;
+
+  // By id, INVALID_SLOT if not one of our ships.
+  std::vector<int> row_of_;
+  std::vector<double> row_x_;
+  std::vector<double> row_y_;
+  std::vector<double> row_radius_;
+
+  Table ships_;
+  Table planets_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_DISTANCE_CACHE_H_
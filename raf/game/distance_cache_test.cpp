@@ -0,0 +1,196 @@
+#include "distance_cache.hpp"
+#include "entity_store.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+using raf::game::DistanceCache;
+using raf::game::EntityId;
+using raf::game::EntityStore;
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::Planet;
+using raf::game::Ship;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+
+static const Vec2i DIMENSIONS(384, 256);
+
+struct World {
+  EntityStore<Ship> friendly;
+  EntityStore<Ship> enemy;
+  EntityStore<Planet> planets;
+};
+
+// Ship and planet ids share a range, as they do in the game.
+static void populate(World& world, int ships, int planets, std::mt19937& rng) {
+  std::uniform_real_distribution<double> x(0, DIMENSIONS.x());
+  std::uniform_real_distribution<double> y(0, DIMENSIONS.y());
+  std::uniform_real_distribution<double> radius(3, 10);
+  for (EntityId id = 0; id < ships; id++) {
+    const Ship ship(id, id % 3 == 0 ? 0 : 1, { x(rng), y(rng) }, 0.5, 255);
+    (ship.owner() == 0 ? world.friendly : world.enemy).upsert(id, ship);
+  }
+  for (EntityId id = 0; id < planets; id++) {
+    world.planets.upsert(id, Planet(id, INVALID_ENTITIY_ID, { x(rng), y(rng) }, radius(rng), 1000, 3));
+  }
+}
+
+static void expect_entity_distances(const DistanceCache& cache, const World& world) {
+  for (const auto& ship : world.friendly) {
+    for (const auto& enemy : world.enemy) {
+      ASSERT_EQ(ship.distance_to(enemy), cache.ship_distance(ship.id(), enemy.id()));
+      ASSERT_EQ(ship.distance_to_edge(enemy), cache.ship_edge_distance(ship.id(), enemy.id()));
+      ASSERT_EQ(enemy.distance_min_turns(ship), cache.ship_turns(ship.id(), enemy.id()));
+      ASSERT_EQ(ship.distance_to_edge_min_turns(enemy), cache.ship_edge_turns(ship.id(), enemy.id()));
+    }
+    for (const auto& planet : world.planets) {
+      ASSERT_EQ(planet.distance_to(ship), cache.planet_distance(ship.id(), planet.id()));
+      ASSERT_EQ(ship.distance_to_edge(planet), cache.planet_edge_distance(ship.id(), planet.id()));
+      ASSERT_EQ(planet.distance_min_turns(ship), cache.planet_turns(ship.id(), planet.id()));
+      ASSERT_EQ(ship.distance_to_edge_min_turns(planet), cache.planet_edge_turns(ship.id(), planet.id()));
+    }
+  }
+}
+
+// Nearest by a plain scan, lowest id first on a tie.
+template<typename T>
+static EntityId scan_nearest(const Ship& ship, const EntityStore<T>& others) {
+  EntityId nearest = INVALID_ENTITIY_ID;
+  double nearest_distance = 0.0;
+  for (const auto& other : others) {
+    const auto distance = ship.distance_to(other);
+    if (nearest == INVALID_ENTITIY_ID || distance < nearest_distance) {
+      nearest = other.id();
+      nearest_distance = distance;
+    }
+  }
+  return nearest;
+}
+
+static void expect_nearest(const DistanceCache& cache, const World& world) {
+  for (const auto& ship : world.friendly) {
+    ASSERT_EQ(scan_nearest(ship, world.enemy), cache.nearest_ship(ship.id()));
+    ASSERT_EQ(scan_nearest(ship, world.planets), cache.nearest_planet(ship.id()));
+  }
+}
+
+TEST(raf_distance_cache, dense_matches_entities)
+{
+  std::mt19937 rng(1);
+  World world;
+  populate(world, 150, 22, rng);
+  DistanceCache cache(DIMENSIONS);
+  cache.build(world.friendly, world.enemy, world.planets);
+
+  ASSERT_TRUE(cache.is_ship_table_dense());
+  ASSERT_TRUE(cache.is_planet_table_dense());
+  expect_entity_distances(cache, world);
+  expect_nearest(cache, world);
+}
+
+TEST(raf_distance_cache, sparse_matches_entities)
+{
+  std::mt19937 rng(2);
+  World world;
+  populate(world, 150, 22, rng);
+  DistanceCache cache(DIMENSIONS, 100);
+  cache.build(world.friendly, world.enemy, world.planets);
+
+  ASSERT_FALSE(cache.is_ship_table_dense());
+  ASSERT_FALSE(cache.is_planet_table_dense());
+  expect_entity_distances(cache, world);
+  expect_nearest(cache, world);
+}
+
+TEST(raf_distance_cache, nearest_out_of_sparse_range)
+{
+  World world;
+  world.friendly.upsert(0, Ship(0, 0, { 10, 10 }, 0.5, 255));
+  world.friendly.upsert(1, Ship(1, 0, { 20, 10 }, 0.5, 255));
+  // Out of range of both, and equally far from ship 0.
+  world.enemy.upsert(5, Ship(5, 1, { 215, 10 }, 0.5, 255));
+  world.enemy.upsert(3, Ship(3, 1, { 10, 215 }, 0.5, 255));
+  DistanceCache cache(DIMENSIONS, 1);
+  cache.build(world.friendly, world.enemy, world.planets);
+
+  ASSERT_FALSE(cache.is_ship_table_dense());
+  ASSERT_EQ(3, cache.nearest_ship(0));
+  ASSERT_EQ(5, cache.nearest_ship(1));
+  ASSERT_EQ(INVALID_ENTITIY_ID, cache.nearest_planet(0));
+  ASSERT_THROW(cache.nearest_ship(2), std::out_of_range);
+}
+
+TEST(raf_distance_cache, rebuilds_each_frame)
+{
+  std::mt19937 rng(3);
+  World world;
+  populate(world, 30, 5, rng);
+  DistanceCache cache(DIMENSIONS);
+  cache.build(world.friendly, world.enemy, world.planets);
+
+  // Ships move and die between frames.
+  world.enemy.erase_if([](const Ship& ship) { return ship.id() % 2 == 0; });
+  for (const auto& ship : world.friendly) {
+    auto moved = ship;
+    moved.update_location(ship.current_location() + Vec2d(7, 0));
+    world.friendly.upsert(ship.id(), moved);
+  }
+  cache.build(world.friendly, world.enemy, world.planets);
+
+  expect_entity_distances(cache, world);
+  ASSERT_THROW(cache.ship_distance(0, 2), std::out_of_range);
+  ASSERT_THROW(cache.ship_distance(1, 3), std::out_of_range);
+  ASSERT_THROW(cache.planet_distance(0, 5), std::out_of_range);
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(raf_distance_cache, DISABLED_benchmark_build)
+{
+  using Clock = std::chrono::steady_clock;
+  for (const int ships : { 200, 600 }) {
+    std::mt19937 rng(ships);
+    World world;
+    populate(world, ships, 28, rng);
+
+    const int rounds = 100;
+    DistanceCache cache(DIMENSIONS);
+    auto start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+      cache.build(world.friendly, world.enemy, world.planets);
+    }
+    const auto build = Clock::now() - start;
+
+    // The lookups a frame makes, against computing them each time.
+    double sum = 0;
+    start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+      for (const auto& ship : world.friendly) {
+        for (const auto& enemy : world.enemy) {
+          sum += ship.distance_to_edge_min_turns(enemy);
+        }
+      }
+    }
+    const auto computed = Clock::now() - start;
+    start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+      for (const auto& ship : world.friendly) {
+        for (const auto& enemy : world.enemy) {
+          sum -= cache.ship_edge_turns(ship.id(), enemy.id());
+        }
+      }
+    }
+    const auto cached = Clock::now() - start;
+
+    std::cout << ships << " ships: build "
+      << std::chrono::duration<double, std::micro>(build).count() / rounds << "us, computed "
+      << std::chrono::duration<double, std::micro>(computed).count() / rounds << "us, cached "
+      << std::chrono::duration<double, std::micro>(cached).count() / rounds << "us ("
+      << sum << ")" << std::endl;
+  }
+}
@@ -26,24 +26,6 @@ void Entity::update(const hlt::Entity& entity) {
   owner_ = entity.owner_id;
 }
 
-// Probably makes more sense as a matrix at game level?
-EntityId Entity::nearest_entity() const {
-  // Find the entity with the shortest distance
-  const auto min = std::min_element(
-    vec_to_.cbegin(),
-    vec_to_.cend(),
-    [](const decltype(vec_to_)::value_type &lhs, const decltype(vec_to_)::value_type &rhs) -> bool { return lhs.second.length() < rhs.second.length(); }
-  );
-
-  if (min != vec_to_.cend())
-    return min->first;
-
-  // This shouldn't really happen, but return ourselves if no other entities were found.
-  // Candidate for exception throw.
-  return id();
-}
-
-
 // Simple collision filter test.
 // Given locations, distance travelled and velocity, see if they could possibly ever hit based on the length alone.
 bool possible_collision(
@@ -75,12 +57,7 @@ math::Vec2d nearest_attack_point(const Entity & target, const Entity & subject)
   const auto target_pos = target.current_location();
   const auto subject_pos = subject.current_location();
 
-  const double angle_rad = target_pos.orient_towards_in_rad(subject_pos);
-
-  const double x = target_pos.x() + radius * std::cos(angle_rad);
-  const double y = target_pos.y() + radius * std::sin(angle_rad);
-
-  return { x, y };
+  return math::point_towards(target_pos, subject_pos, radius);
 }
 
 math::Vec2d nearest_dock_point(const Entity & target, const Entity & subject) {
@@ -88,6 +65,7 @@ math::Vec2d nearest_dock_point(const Entity & target, const Entity & subject) {
 
   // Make the target look at the subject so we can plot the nearest point from center of
   // target on a vector aiming at the subject.
+  // Kept on the trig path, see get_closest_point.
   const auto target_pos = target.current_location();
   const auto subject_pos = subject.current_location();
 
@@ -6,7 +6,6 @@
 #include "../math/math.hpp"
 
 #include <algorithm>
-#include <map>
 
 namespace raf {
 namespace game {
@@ -77,6 +76,29 @@ public:
     return (current_location_ - a.current_location_).length();
   }
 
+  // Squared distances, for comparing without a sqrt.
+  double distance_squared_to(const math::Vec2d& a) const {
+    return (current_location_ - a).length_squared();
+  }
+
+  double distance_squared_to(const Entity& a) const {
+    return (current_location_ - a.current_location_).length_squared();
+  }
+
+  // Square of the centre distance at which the edges of this and a are
+  // edge_distance apart. Compare distance_squared_to(a) against this rather
+  // than distance_to_edge(a) against edge_distance; the two agree except
+  // within rounding of the boundary. edge_distance must be at least
+  // -(radius() + a.radius()).
+  double edge_distance_squared(const Entity& a, double edge_distance) const {
+    const double centre_distance = edge_distance + a.radius() + radius();
+    return centre_distance * centre_distance;
+  }
+
+  bool is_edge_within(const Entity& a, double edge_distance) const {
+    return distance_squared_to(a) <= edge_distance_squared(a, edge_distance);
+  }
+
   double distance_to_edge(const Entity& a) const {
     return (current_location_ - a.current_location_).length() - a.radius() - radius();
   }
@@ -91,15 +113,6 @@ public:
 
   math::Vec2d current_location() const { return current_location_; }
 
-  void update_distance(const Entity& a) {
-    // Do we want this to be to origin, or edge... i.e. include radius?
-    vec_to_[a.id()] = a.current_location_ - current_location_;
-  }
-
-  // Probably makes more sense as a matrix at game level?
-  // Returns the EntityId of the nearest entity "as the crow flies"
-  EntityId nearest_entity() const;
-
   friend bool possible_collision(
     const Entity& a,
     const Entity& b,
@@ -122,9 +135,6 @@ private:
   math::Vec2d velocity_;
   math::Vec2d previous_velocity_;
   double radius_;
-
-  // vector offset to get to another entity.
-  std::map<EntityId, math::Vec2d> vec_to_;
 };
 
 math::Vec2d nearest_attack_point(const Entity& target, const Entity& subject);
@@ -0,0 +1,429 @@
+#ifndef RAF_GAME_ENTITY_STORE_H_
+#define RAF_GAME_ENTITY_STORE_H_
+
+#include "entity.hpp"
+#include "planet.hpp"
+#include "player.hpp"
+#include "ship.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Entities per storage chunk.
+constexpr int ENTITY_STORE_CHUNK_SIZE = 256;
+
+// The hot fields of every live entity as parallel arrays, in id order.
+// Row i of every column describes the same entity.
+struct EntityColumns {
+  std::vector<EntityId> id;
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> radius;
+  std::vector<int> health;
+  std::vector<PlayerId> owner;
+  // DockingStatus of a ship, docked ship count of a planet.
+  std::vector<int> docking;
+
+  size_t size() const { return id.size(); }
+
+  void clear() {
+    id.clear();
+    x.clear();
+    y.clear();
+    radius.clear();
+    health.clear();
+    owner.clear();
+    docking.clear();
+  }
+};
+
+// Dense store of ships or planets keyed by entity id.
+//
+// Replaces std::map<EntityId, T>. Entities live in fixed size chunks and
+// never move once added, so HierarchicalGrid and PlanetIndex can keep
+// pointing at them, and the slots of dead entities are reused. A slot is
+// the entity's handle, found from its id through a flat table.
+//
+// Iteration visits entities in id order, as iterating the map did, so
+// anything that picks the first of equals behaves the same. Passes that only
+// need location, owner, health or docking state can stream through
+// columns() instead of touching the entities at all.
+template<typename T>
+class EntityStore {
+public:
+  using Handle = int;
+  static constexpr Handle INVALID_HANDLE = -1;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() : store_(nullptr) {}
+    const_iterator(const EntityStore* store, std::vector<Handle>::const_iterator at)
+      : store_(store), at_(at) {
+    }
+
+    reference operator*() const { return store_->get(*at_); }
+    pointer operator->() const { return &store_->get(*at_); }
+    const_iterator& operator++() { ++at_; return *this; }
+    const_iterator operator++(int) { auto old = *this; ++at_; return old; }
+    bool operator==(const const_iterator& other) const { return at_ == other.at_; }
+    bool operator!=(const const_iterator& other) const { return at_ != other.at_; }
+
+  private:
+    const EntityStore* store_;
+    std::vector<Handle>::const_iterator at_;
+  };
+
+  EntityStore() : columns_stale_(false) {}
+  ~EntityStore() { clear(); }
+
+  // Moving keeps the chunks, so entities stay where they are.
+  EntityStore(EntityStore&& other) : columns_stale_(true) {
+    *this = std::move(other);
+  }
+
+  EntityStore& operator=(EntityStore&& other) {
+    if (this != &other) {
+      clear();
+      chunks_ = std::move(other.chunks_);
+      free_ = std::move(other.free_);
+      handles_ = std::move(other.handles_);
+      order_ = std::move(other.order_);
+      position_ = std::move(other.position_);
+      columns_stale_ = true;
+      other.order_.clear();
+      other.clear();
+    }
+    return *this;
+  }
+
+  EntityStore(const EntityStore&) = delete;
+  EntityStore& operator=(const EntityStore&) = delete;
+
+  // Create the entity from snapshot, or update it if id is already here.
+  // The snapshot is anything T can be built from and update()d with, or a
+  // T to copy. Returns the entity and whether it was created.
+  template<typename Snapshot>
+  std::pair<T*, bool> upsert(EntityId id, const Snapshot& snapshot) {
+    const auto existing = handle_of(id);
+    if (existing != INVALID_HANDLE) {
+      auto& entity = mutable_get(existing);
+      apply(entity, snapshot);
+      if (!columns_stale_) {
+        write_row(position_[existing], entity);
+      }
+      return { &entity, false };
+    }
+
+    const auto handle = allocate();
+    auto* entity = new (slot(handle)) T(snapshot);
+    if (id >= static_cast<EntityId>(handles_.size())) {
+      handles_.resize(id + 1, INVALID_HANDLE);
+    }
+    handles_[id] = handle;
+    // New ids are nearly always the largest yet, so this is an append.
+    const auto at = std::upper_bound(std::begin(order_), std::end(order_), id, [this](EntityId value, Handle h) {
+      return value < get(h).id();
+    });
+    order_.insert(at, handle);
+    columns_stale_ = true;
+    return { entity, true };
+  }
+
+  // Remove every entity pred is true for. pred sees them in id order.
+  template<typename Pred>
+  void erase_if(const Pred& pred) {
+    auto kept = std::begin(order_);
+    for (const auto handle : order_) {
+      if (pred(get(handle))) {
+        release(handle);
+      } else {
+        *kept++ = handle;
+      }
+    }
+    if (kept != std::end(order_)) {
+      order_.erase(kept, std::end(order_));
+      columns_stale_ = true;
+    }
+  }
+
+  void clear() {
+    for (const auto handle : order_) {
+      release(handle);
+    }
+    order_.clear();
+    free_.clear();
+    handles_.clear();
+    position_.clear();
+    chunks_.clear();
+    columns_stale_ = true;
+  }
+
+  Handle handle_of(EntityId id) const {
+    if (id < 0 || id >= static_cast<EntityId>(handles_.size())) {
+      return INVALID_HANDLE;
+    }
+    return handles_[id];
+  }
+
+  const T& get(Handle handle) const {
+    return *reinterpret_cast<const T*>(slot(handle));
+  }
+
+  // nullptr if id is not here.
+  const T* find(EntityId id) const {
+    const auto handle = handle_of(id);
+    return handle == INVALID_HANDLE ? nullptr : &get(handle);
+  }
+
+  // Throws std::out_of_range if id is not here, as std::map::at() does.
+  const T& at(EntityId id) const {
+    const auto handle = handle_of(id);
+    if (handle == INVALID_HANDLE) {
+      throw std::out_of_range("EntityStore::at");
+    }
+    return get(handle);
+  }
+
+  bool contains(EntityId id) const { return handle_of(id) != INVALID_HANDLE; }
+  size_t count(EntityId id) const { return contains(id) ? 1 : 0; }
+  size_t size() const { return order_.size(); }
+  bool empty() const { return order_.empty(); }
+
+  const_iterator begin() const { return const_iterator(this, std::begin(order_)); }
+  const_iterator end() const { return const_iterator(this, std::end(order_)); }
+
+  // Hot fields of every entity, row i being the i-th entity in id order.
+  // Rebuilt on first use after entities were added or removed, updated in
+  // place by upsert() otherwise.
+  const EntityColumns& columns() const {
+    if (columns_stale_) {
+      rebuild_columns();
+    }
+    return columns_;
+  }
+
+private:
+  using Storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+  using Chunk = std::unique_ptr<Storage[]>;
+
+  static void apply(T& entity, const T& value) { entity = value; }
+  template<typename Snapshot>
+  static void apply(T& entity, const Snapshot& snapshot) { entity.update(snapshot); }
+
+  static int docking_of(const Ship& ship) { return static_cast<int>(ship.docking_status()); }
+  static int docking_of(const Planet& planet) { return static_cast<int>(planet.used_docking_spots()); }
+
+  T& mutable_get(Handle handle) {
+    return *reinterpret_cast<T*>(slot(handle));
+  }
+
+  void* slot(Handle handle) const {
+    return &chunks_[handle / ENTITY_STORE_CHUNK_SIZE][handle % ENTITY_STORE_CHUNK_SIZE];
+  }
+
+  Handle allocate() {
+    if (!free_.empty()) {
+      const auto handle = free_.back();
+      free_.pop_back();
+      return handle;
+    }
+    const auto handle = static_cast<Handle>(position_.size());
+    if (handle % ENTITY_STORE_CHUNK_SIZE == 0) {
+      chunks_.emplace_back(new Storage[ENTITY_STORE_CHUNK_SIZE]);
+    }
+    position_.push_back(0);
+    return handle;
+  }
+
+  // Destroys the entity, the caller drops it from order_.
+  void release(Handle handle) {
+    auto& entity = mutable_get(handle);
+    handles_[entity.id()] = INVALID_HANDLE;
+    entity.~T();
+    free_.push_back(handle);
+  }
+
+  void write_row(size_t row, const T& entity) const {
+    columns_.id[row] = entity.id();
+    columns_.x[row] = entity.current_location().x();
+    columns_.y[row] = entity.current_location().y();
+    columns_.radius[row] = entity.radius();
+    columns_.health[row] = entity.health();
+    columns_.owner[row] = entity.owner();
+    columns_.docking[row] = docking_of(entity);
+  }
+
+  void rebuild_columns() const {
+    const auto rows = order_.size();
+    columns_.id.resize(rows);
+    columns_.x.resize(rows);
+    columns_.y.resize(rows);
+    columns_.radius.resize(rows);
+    columns_.health.resize(rows);
+    columns_.owner.resize(rows);
+    columns_.docking.resize(rows);
+    for (size_t row = 0; row < rows; row++) {
+      const auto handle = order_[row];
+      position_[handle] = row;
+      write_row(row, get(handle));
+    }
+    columns_stale_ = false;
+  }
+
+  std::vector<Chunk> chunks_;
+  // Handles of the free slots.
+  std::vector<Handle> free_;
+  // By entity id, INVALID_HANDLE if not here.
+  std::vector<Handle> handles_;
+  // Handles of the live entities in id order.
+  std::vector<Handle> order_;
+
+  mutable EntityColumns columns_;
+  // By handle, the entity's row in columns_.
+  mutable std::vector<size_t> position_;
+  mutable bool columns_stale_;
+};
+
+template<typename T>
+constexpr typename EntityStore<T>::Handle EntityStore<T>::INVALID_HANDLE;
+
+// Read only view over up to two stores or vectors, visited one after the
+// other, without copying the entities.
+//
+// Holds pointers only, so it must not outlive what it views. Navigation and
+// PathFinder take one wherever they used to take a std::vector of entities.
+template<typename T>
+class EntityView {
+public:
+  static constexpr int MAX_PARTS = 2;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() : view_(nullptr), part_(0), span_at_(nullptr) {}
+    const_iterator(const EntityView* view, int part)
+      : view_(view), part_(part), span_at_(nullptr) {
+      enter_part();
+    }
+
+    reference operator*() const {
+      return view_->parts_[part_].store ? *store_at_ : *span_at_;
+    }
+    pointer operator->() const { return &**this; }
+
+    const_iterator& operator++() {
+      const auto& part = view_->parts_[part_];
+      if (part.store) {
+        ++store_at_;
+        if (store_at_ != part.store->end()) {
+          return *this;
+        }
+      } else if (++span_at_ != part.last) {
+        return *this;
+      }
+      part_++;
+      enter_part();
+      return *this;
+    }
+    const_iterator operator++(int) { auto old = *this; ++*this; return old; }
+
+    bool operator==(const const_iterator& other) const {
+      return part_ == other.part_ && (part_ == view_->count_ || &**this == &*other);
+    }
+    bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+  private:
+    // Move to the first entity at or after the start of part_, skipping
+    // empty parts.
+    void enter_part() {
+      for (; part_ < view_->count_; part_++) {
+        const auto& part = view_->parts_[part_];
+        if (part.store && !part.store->empty()) {
+          store_at_ = part.store->begin();
+          return;
+        }
+        if (!part.store && part.first != part.last) {
+          span_at_ = part.first;
+          return;
+        }
+      }
+    }
+
+    const EntityView* view_;
+    int part_;
+    typename EntityStore<T>::const_iterator store_at_;
+    const T* span_at_;
+  };
+
+  EntityView() : count_(0) {}
+  EntityView(const EntityStore<T>& store) : count_(0) {
+    add(store);
+  }
+  EntityView(const std::vector<T>& entities) : count_(0) {
+    add(entities);
+  }
+  EntityView(const EntityStore<T>& first, const EntityStore<T>& second) : count_(0) {
+    add(first);
+    add(second);
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (int i = 0; i < count_; i++) {
+      size += parts_[i].store ? parts_[i].store->size() : parts_[i].last - parts_[i].first;
+    }
+    return size;
+  }
+  bool empty() const { return size() == 0; }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, count_); }
+
+private:
+  struct Part {
+    const EntityStore<T>* store;
+    const T* first;
+    const T* last;
+  };
+
+  void add(const EntityStore<T>& store) {
+    parts_[count_++] = { &store, nullptr, nullptr };
+  }
+
+  void add(const std::vector<T>& entities) {
+    parts_[count_++] = { nullptr, entities.data(), entities.data() + entities.size() };
+  }
+
+  std::array<Part, MAX_PARTS> parts_;
+  int count_;
+};
+
+template<typename T>
+constexpr int EntityView<T>::MAX_PARTS;
+
+}
+}
+
+#endif // !RAF_GAME_ENTITY_STORE_H_
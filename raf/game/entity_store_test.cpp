@@ -0,0 +1,166 @@
+#include "entity_store.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "gtest/gtest.h"
+
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using raf::game::DockingStatus;
+using raf::game::EntityId;
+using raf::game::EntityStore;
+using raf::game::EntityView;
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::Planet;
+using raf::game::Ship;
+using raf::math::Vec2d;
+
+static Ship make_ship(EntityId id, int owner, const Vec2d& location, int health = 255) {
+  return Ship(id, owner, location, 0.5, health);
+}
+
+static std::vector<EntityId> ids_of(const EntityStore<Ship>& ships) {
+  std::vector<EntityId> ids;
+  for (const auto& ship : ships) {
+    ids.push_back(ship.id());
+  }
+  return ids;
+}
+
+TEST(raf_entity_store, iterates_in_id_order)
+{
+  EntityStore<Ship> ships;
+  for (const EntityId id : { 7, 2, 9, 0, 4 }) {
+    ASSERT_TRUE(ships.upsert(id, make_ship(id, 0, { 1.0 * id, 0 })).second);
+  }
+  ASSERT_EQ(5u, ships.size());
+  ASSERT_EQ(std::vector<EntityId>({ 0, 2, 4, 7, 9 }), ids_of(ships));
+
+  ASSERT_FALSE(ships.upsert(4, make_ship(4, 0, { 40, 0 })).second);
+  ASSERT_EQ(5u, ships.size());
+  ASSERT_EQ(Vec2d(40, 0), ships.at(4).current_location());
+
+  ASSERT_TRUE(ships.contains(9));
+  ASSERT_FALSE(ships.contains(3));
+  ASSERT_FALSE(ships.contains(100));
+  ASSERT_EQ(nullptr, ships.find(3));
+  ASSERT_THROW(ships.at(3), std::out_of_range);
+}
+
+TEST(raf_entity_store, entities_never_move)
+{
+  EntityStore<Ship> ships;
+  std::vector<const Ship*> addresses;
+  for (EntityId id = 0; id < 1000; id++) {
+    addresses.push_back(ships.upsert(id, make_ship(id, id % 4, { 0, 0 })).first);
+  }
+  ships.erase_if([](const Ship& ship) { return ship.id() % 3 == 0; });
+  for (EntityId id = 0; id < 1000; id++) {
+    ASSERT_EQ(id % 3 == 0 ? nullptr : addresses[id], ships.find(id));
+  }
+
+  // Freed slots are reused, nothing else moves.
+  const auto* reused = ships.upsert(1000, make_ship(1000, 0, { 0, 0 })).first;
+  ASSERT_EQ(addresses[999], reused);
+  ASSERT_EQ(addresses[998], ships.find(998));
+  ASSERT_EQ(1000, ids_of(ships).back());
+
+  // Nor does moving the store.
+  EntityStore<Ship> moved(std::move(ships));
+  ASSERT_EQ(addresses[998], moved.find(998));
+  ASSERT_EQ(667u, moved.size());
+}
+
+TEST(raf_entity_store, columns_match_entities)
+{
+  EntityStore<Ship> ships;
+  std::map<EntityId, Ship> expected;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> coordinate(0, 240);
+  std::uniform_int_distribution<int> owner(0, 3);
+  EntityId next = 0;
+  for (int round = 0; round < 20; round++) {
+    for (int i = 0; i < 10; i++) {
+      const auto ship = make_ship(next, owner(rng), { coordinate(rng), coordinate(rng) }, 10 + next);
+      ships.upsert(next, ship);
+      expected.emplace(next, ship);
+      next++;
+    }
+    // Move some, kill some.
+    for (auto& e : expected) {
+      if (e.first % 5 == round % 5) {
+        e.second.update_location({ coordinate(rng), coordinate(rng) });
+        ships.upsert(e.first, e.second);
+      }
+    }
+    ships.erase_if([round](const Ship& ship) { return ship.id() % 7 == round % 7; });
+    for (auto it = std::begin(expected); it != std::end(expected); ) {
+      it = it->first % 7 == round % 7 ? expected.erase(it) : std::next(it);
+    }
+
+    const auto& columns = ships.columns();
+    ASSERT_EQ(expected.size(), columns.size());
+    size_t row = 0;
+    for (const auto& e : expected) {
+      const auto& ship = e.second;
+      ASSERT_EQ(ship.id(), columns.id[row]);
+      ASSERT_EQ(ship.current_location().x(), columns.x[row]);
+      ASSERT_EQ(ship.current_location().y(), columns.y[row]);
+      ASSERT_EQ(ship.radius(), columns.radius[row]);
+      ASSERT_EQ(ship.health(), columns.health[row]);
+      ASSERT_EQ(ship.owner(), columns.owner[row]);
+      ASSERT_EQ(static_cast<int>(DockingStatus::Undocked), columns.docking[row]);
+      row++;
+    }
+  }
+}
+
+TEST(raf_entity_store, planet_docking_column)
+{
+  EntityStore<Planet> planets;
+  Planet planet(3, 1, { 50, 50 }, 6, 1000, 4);
+  planets.upsert(3, planet);
+  planets.upsert(5, Planet(5, INVALID_ENTITIY_ID, { 80, 50 }, 4, 1000, 2));
+  ASSERT_EQ(std::vector<int>({ 0, 0 }), planets.columns().docking);
+
+  planet.dock_ship(10);
+  planet.dock_ship(11);
+  planets.upsert(3, planet);
+  ASSERT_EQ(std::vector<int>({ 2, 0 }), planets.columns().docking);
+}
+
+TEST(raf_entity_store, view_chains_parts_without_copying)
+{
+  EntityStore<Ship> mine;
+  EntityStore<Ship> theirs;
+  EntityStore<Ship> none;
+  for (const EntityId id : { 4, 1 }) {
+    mine.upsert(id, make_ship(id, 0, { 0, 0 }));
+  }
+  for (const EntityId id : { 3, 0, 8 }) {
+    theirs.upsert(id, make_ship(id, 1, { 0, 0 }));
+  }
+
+  const EntityView<Ship> both(mine, theirs);
+  ASSERT_EQ(5u, both.size());
+  std::vector<EntityId> ids;
+  for (const auto& ship : both) {
+    ASSERT_EQ(ship.owner() == 0 ? mine.find(ship.id()) : theirs.find(ship.id()), &ship);
+    ids.push_back(ship.id());
+  }
+  ASSERT_EQ(std::vector<EntityId>({ 1, 4, 0, 3, 8 }), ids);
+
+  // Empty parts are skipped.
+  const EntityView<Ship> skipped(none, theirs);
+  ASSERT_EQ(3u, std::distance(std::begin(skipped), std::end(skipped)));
+  ASSERT_TRUE(EntityView<Ship>(none, none).empty());
+  ASSERT_TRUE(std::begin(EntityView<Ship>()) == std::end(EntityView<Ship>()));
+
+  const std::vector<Ship> vector = { make_ship(5, 0, { 0, 0 }), make_ship(6, 0, { 0, 0 }) };
+  const EntityView<Ship> span(vector);
+  ASSERT_EQ(2u, span.size());
+  ASSERT_EQ(&vector.back(), &*std::next(std::begin(span)));
+}
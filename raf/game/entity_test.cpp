@@ -0,0 +1,55 @@
+#include "entity.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <type_traits>
+
+using raf::game::Entity;
+using raf::game::Planet;
+using raf::game::Ship;
+using raf::math::Vec2d;
+
+TEST(raf_entity, distance_squared)
+{
+  const Entity a(0, 0, { 1, 2 }, 0.5, 255);
+  const Entity b(1, 0, { 4, 6 }, 2.0, 255);
+  ASSERT_DOUBLE_EQ(25, a.distance_squared_to(b));
+  ASSERT_DOUBLE_EQ(25, a.distance_squared_to(Vec2d(4, 6)));
+  ASSERT_DOUBLE_EQ(a.distance_to(b) * a.distance_to(b), a.distance_squared_to(b));
+}
+
+TEST(raf_entity, edge_distance_squared)
+{
+  const Entity a(0, 0, { 0, 0 }, 0.5, 255);
+  const Entity b(1, 0, { 10, 0 }, 2.0, 255);
+  // Edges are 7.5 apart.
+  ASSERT_DOUBLE_EQ(7.5, a.distance_to_edge(b));
+  ASSERT_DOUBLE_EQ(100, a.edge_distance_squared(b, 7.5));
+  ASSERT_TRUE(a.is_edge_within(b, 7.5));
+  ASSERT_TRUE(a.is_edge_within(b, 8));
+  ASSERT_FALSE(a.is_edge_within(b, 7));
+}
+
+TEST(raf_entity, edge_within_matches_distance_to_edge)
+{
+  std::mt19937 rng(6);
+  std::uniform_real_distribution<double> coordinate(0, 200);
+  std::uniform_real_distribution<double> radius(0.5, 10);
+  std::uniform_real_distribution<double> range(0, 60);
+  for (int i = 0; i < 10000; i++) {
+    const Entity a(0, 0, { coordinate(rng), coordinate(rng) }, radius(rng), 255);
+    const Entity b(1, 0, { coordinate(rng), coordinate(rng) }, radius(rng), 255);
+    const double edge_distance = range(rng);
+    ASSERT_EQ(a.distance_to_edge(b) <= edge_distance, a.is_edge_within(b, edge_distance));
+  }
+}
+
+TEST(raf_entity, trivially_copyable)
+{
+  // run_frame copies entities freely, none of them may own memory.
+  ASSERT_TRUE(std::is_trivially_copyable<Entity>::value);
+  ASSERT_TRUE(std::is_trivially_copyable<Ship>::value);
+  ASSERT_TRUE(std::is_trivially_copyable<Planet>::value);
+}
@@ -0,0 +1,79 @@
+#include "frame_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace raf {
+namespace game {
+
+FrameArena::FrameArena(size_t block_size)
+  : current_(0),
+  offset_(0),
+  spilled_(0),
+  bytes_allocated_(0),
+  peak_bytes_(0),
+  block_allocations_(0) {
+  add_block(block_size);
+}
+
+void FrameArena::add_block(size_t size) {
+  blocks_.push_back({ std::unique_ptr<char[]>(new char[size]), size });
+  block_allocations_++;
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+  bytes_allocated_ += bytes;
+  for (;;) {
+    auto& block = blocks_[current_];
+    const auto base = reinterpret_cast<std::uintptr_t>(block.memory.get());
+    const auto start = (base + offset_ + alignment - 1) / alignment * alignment - base;
+    if (start + bytes <= block.size) {
+      offset_ = start + bytes;
+      peak_bytes_ = std::max(peak_bytes_, spilled_ + offset_);
+      return block.memory.get() + start;
+    }
+    // Move on to the next block, adding one if this was the last.
+    spilled_ += offset_;
+    offset_ = 0;
+    current_++;
+    if (current_ == blocks_.size()) {
+      add_block(std::max(blocks_.back().size * 2, bytes + alignment));
+    }
+  }
+}
+
+void FrameArena::deallocate(void* p, size_t bytes) {
+  auto* block = blocks_[current_].memory.get();
+  if (static_cast<char*>(p) + bytes == block + offset_) {
+    offset_ = static_cast<char*>(p) - block;
+  }
+}
+
+void FrameArena::reset() {
+  if (blocks_.size() > 1) {
+    const auto size = capacity();
+    blocks_.clear();
+    add_block(size);
+  }
+  current_ = 0;
+  offset_ = 0;
+  spilled_ = 0;
+  bytes_allocated_ = 0;
+  peak_bytes_ = 0;
+}
+
+size_t FrameArena::capacity() const {
+  size_t size = 0;
+  for (const auto& block : blocks_) {
+    size += block.size;
+  }
+  return size;
+}
+
+FrameArena& frame_arena() {
+  static FrameArena arena;
+  return arena;
+}
+
+}
+}
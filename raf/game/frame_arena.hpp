@@ -0,0 +1,99 @@
+#ifndef RAF_GAME_FRAME_ARENA_H_
+#define RAF_GAME_FRAME_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Size of the first block of a FrameArena.
+constexpr size_t FRAME_ARENA_BLOCK_SIZE = 64 * 1024;
+
+// Bump allocator for memory that only lives until the end of a frame.
+//
+// Allocation moves a pointer through the current block, and reset() releases
+// everything at once. Freeing is a no-op unless it is the most recent
+// allocation, which is handed back, so a vector growing on its own reuses its
+// old space. A frame that outgrows the block spills into more blocks, and the
+// next reset() swaps them for one block that holds it all, so once frames
+// settle the arena makes no heap allocations at all.
+class FrameArena {
+public:
+  FrameArena(size_t block_size = FRAME_ARENA_BLOCK_SIZE);
+
+  void* allocate(size_t bytes, size_t alignment);
+  void deallocate(void* p, size_t bytes);
+
+  // Start a new frame. Anything allocated before is invalid.
+  void reset();
+
+  // Bytes handed out since reset(), counting memory handed back.
+  size_t bytes_allocated() const { return bytes_allocated_; }
+  // Most bytes in use at once since reset().
+  size_t peak_bytes() const { return peak_bytes_; }
+  // Total size of the blocks held.
+  size_t capacity() const;
+  // Blocks taken from the heap since construction.
+  size_t block_allocations() const { return block_allocations_; }
+
+private:
+  struct Block {
+    std::unique_ptr<char[]> memory;
+    size_t size;
+  };
+
+  void add_block(size_t size);
+
+  std::vector<Block> blocks_;
+  size_t current_;
+  size_t offset_;
+  // Bytes in use in blocks before current_.
+  size_t spilled_;
+  size_t bytes_allocated_;
+  size_t peak_bytes_;
+  size_t block_allocations_;
+};
+
+// The arena for raf's per-frame temporaries, reset by MapState::pre_frame().
+FrameArena& frame_arena();
+
+// Standard allocator over a FrameArena, frame_arena() unless given another.
+template<typename T>
+class FrameAllocator {
+public:
+  using value_type = T;
+
+  FrameAllocator() noexcept : arena_(&frame_arena()) {}
+  explicit FrameAllocator(FrameArena& arena) noexcept : arena_(&arena) {}
+  template<typename U>
+  FrameAllocator(const FrameAllocator<U>& other) noexcept : arena_(other.arena()) {}
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* p, size_t count) noexcept {
+    arena_->deallocate(p, count * sizeof(T));
+  }
+
+  FrameArena* arena() const { return arena_; }
+
+private:
+  FrameArena* arena_;
+};
+
+template<typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b) { return a.arena() == b.arena(); }
+template<typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b) { return a.arena() != b.arena(); }
+
+// Vector for temporaries that never outlive the frame.
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+}
+}
+
+#endif // !RAF_GAME_FRAME_ARENA_H_
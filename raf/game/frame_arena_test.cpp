@@ -0,0 +1,126 @@
+#include "frame_arena.hpp"
+#include "ship.hpp"
+#include "raf/stdlib_util.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using raf::game::FrameAllocator;
+using raf::game::FrameArena;
+using raf::game::Ship;
+
+template<typename T>
+using ArenaVector = std::vector<T, FrameAllocator<T>>;
+
+TEST(raf_frame_arena, allocations_are_aligned)
+{
+  FrameArena arena(256);
+  arena.allocate(1, 1);
+  const auto* p = arena.allocate(sizeof(double), alignof(double));
+  ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(p) % alignof(double));
+  arena.allocate(3, 1);
+  const auto* q = arena.allocate(sizeof(Ship), alignof(Ship));
+  ASSERT_EQ(0u, reinterpret_cast<std::uintptr_t>(q) % alignof(Ship));
+}
+
+TEST(raf_frame_arena, last_allocation_is_handed_back)
+{
+  FrameArena arena(256);
+  auto* a = arena.allocate(16, 8);
+  auto* b = arena.allocate(16, 8);
+  // Not the last, nothing changes.
+  arena.deallocate(a, 16);
+  ASSERT_EQ(static_cast<char*>(b) + 16, arena.allocate(16, 8));
+  arena.deallocate(static_cast<char*>(b) + 16, 16);
+  ASSERT_EQ(static_cast<char*>(b) + 16, arena.allocate(16, 8));
+  ASSERT_EQ(48u, arena.peak_bytes());
+  ASSERT_EQ(64u, arena.bytes_allocated());
+}
+
+TEST(raf_frame_arena, spills_then_settles)
+{
+  FrameArena arena(256);
+  ASSERT_EQ(1u, arena.block_allocations());
+
+  size_t settled = 0;
+  for (int frame = 0; frame < 5; frame++) {
+    arena.reset();
+    if (frame == 1) {
+      settled = arena.block_allocations();
+    }
+    ArenaVector<int> a{ FrameAllocator<int>(arena) };
+    ArenaVector<double> b{ FrameAllocator<double>(arena) };
+    for (int i = 0; i < 200; i++) {
+      a.push_back(i);
+      b.push_back(i * 0.5);
+    }
+    for (int i = 0; i < 200; i++) {
+      ASSERT_EQ(i, a[i]);
+      ASSERT_EQ(i * 0.5, b[i]);
+    }
+  }
+
+  // One block holds a whole frame after the first reset, so the heap is
+  // only touched for the first frame and that reset.
+  ASSERT_LT(1u, settled);
+  ASSERT_EQ(settled, arena.block_allocations());
+  arena.reset();
+  ASSERT_EQ(0u, arena.bytes_allocated());
+  ASSERT_GE(arena.capacity(), 200 * (sizeof(int) + sizeof(double)));
+}
+
+TEST(raf_frame_arena, sort_by_key_uses_vector_allocator)
+{
+  FrameArena arena(4096);
+  ArenaVector<int> values{ FrameAllocator<int>(arena) };
+  for (int i = 0; i < 50; i++) {
+    values.push_back((i * 37) % 50);
+  }
+  const auto before = arena.bytes_allocated();
+  raf::sort_by_key(values, [](int v) { return -v; });
+
+  ASSERT_GT(arena.bytes_allocated(), before);
+  ASSERT_EQ(1u, arena.block_allocations());
+  for (int i = 0; i < 50; i++) {
+    ASSERT_EQ(49 - i, values[i]);
+  }
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(raf_frame_arena, DISABLED_benchmark_vectors)
+{
+  using Clock = std::chrono::steady_clock;
+  const int rounds = 10000;
+  const int count = 64;
+  FrameArena arena;
+
+  size_t sum = 0;
+  auto start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    std::vector<int> values;
+    for (int i = 0; i < count; i++) {
+      values.push_back(i);
+    }
+    sum += values.size();
+  }
+  const auto heap = Clock::now() - start;
+
+  start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    arena.reset();
+    ArenaVector<int> values{ FrameAllocator<int>(arena) };
+    for (int i = 0; i < count; i++) {
+      values.push_back(i);
+    }
+    sum += values.size();
+  }
+  const auto arena_time = Clock::now() - start;
+
+  std::cout << count << " ints: heap "
+    << std::chrono::duration<double, std::nano>(heap).count() / rounds << "ns, arena "
+    << std::chrono::duration<double, std::nano>(arena_time).count() / rounds << "ns ("
+    << sum << ")" << std::endl;
+}
@@ -0,0 +1,421 @@
+#ifndef RAF_GAME_HIERARCHICAL_GRID_H_
+#define RAF_GAME_HIERARCHICAL_GRID_H_
+
+#include "../math/math.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Default cell size of the finest level of the hierarchical grid.
+// The levels are 16, 64 and 256 units wide. A fine cell is roughly two turns
+// of movement, so collision and weapon lookahead (about 16 and 21 units) scan
+// a 3x3 or 4x4 block of fine cells, a 13 turn search (85 units) skips empty
+// 64 unit blocks, and whole map questions are answered from the top level.
+constexpr double DEFAULT_HIERARCHY_CELL_SIZE = 16.0;
+
+// Bucketed grid over the map with several levels of resolution.
+//
+// Members are only stored in the finest cells. Every level keeps a count of
+// the entities under each of its cells, so a query skips empty regions at the
+// coarsest level it can, and any cell that lies entirely inside the query
+// circle is answered from its count without visiting members. Scanning a
+// fine cell costs about as much as testing it, so fine cells are never
+// tested, and queries no wider than a level 1 cell scan like a flat grid.
+//
+// The grid does not own entities, it holds pointers to them. Entities must
+// stay at the same address while they are in the grid, otherwise clear() and
+// rebuild it whenever the owning container could reallocate. They are
+// tracked by id, which must be a small non-negative integer (as the game
+// engine assigns them), so update() and remove() need no search.
+template<typename T>
+class HierarchicalGrid {
+public:
+  static constexpr int LEVELS = 3;
+  // Each cell covers BRANCHING x BRANCHING cells of the level below. A power
+  // of two, so walking between levels is a shift rather than a division.
+  static constexpr int BRANCHING_SHIFT = 2;
+  static constexpr int BRANCHING = 1 << BRANCHING_SHIFT;
+
+  HierarchicalGrid(const math::Vec2i& dimensions, double cell_size = DEFAULT_HIERARCHY_CELL_SIZE) {
+    const int fine_columns = std::max(1, static_cast<int>(std::ceil(dimensions.x() / cell_size)));
+    const int fine_rows = std::max(1, static_cast<int>(std::ceil(dimensions.y() / cell_size)));
+    int shift = 0;
+    for (auto& level : levels_) {
+      const int scale = 1 << shift;
+      level.shift = shift;
+      level.scale = scale;
+      level.cell_size = cell_size * scale;
+      level.columns = (fine_columns + scale - 1) / scale;
+      level.rows = (fine_rows + scale - 1) / scale;
+      level.counts.assign(level.columns * level.rows, 0);
+      set_bounds(level.columns, level.cell_size, level.low_x, level.high_x);
+      set_bounds(level.rows, level.cell_size, level.low_y, level.high_y);
+      shift += BRANCHING_SHIFT;
+    }
+    cells_.resize(fine_columns * fine_rows);
+  }
+
+  void clear() {
+    for (auto& cell : cells_) {
+      cell.clear();
+    }
+    for (auto& level : levels_) {
+      std::fill(std::begin(level.counts), std::end(level.counts), 0);
+    }
+    tracked_.clear();
+    size_ = 0;
+  }
+
+  // Entity must not already be in the grid, use update() if it may be.
+  void insert(const T& entity) {
+    add_to_cell(cell_index(entity.current_location()), entity);
+    size_++;
+  }
+
+  // Insert entity, or move it to its current cell if it is already tracked.
+  // A tracked entity must be passed at the same address it was inserted at.
+  void update(const T& entity) {
+    if (!contains(entity)) {
+      insert(entity);
+      return;
+    }
+
+    const auto index = cell_index(entity.current_location());
+    if (index == tracked_[entity.id()].cell) {
+      return;
+    }
+
+    remove_from_cell(entity.id());
+    add_to_cell(index, entity);
+  }
+
+  // Remove entity if it is tracked.
+  void remove(const T& entity) {
+    if (!contains(entity)) {
+      return;
+    }
+    remove_from_cell(entity.id());
+    size_--;
+  }
+
+  bool contains(const T& entity) const {
+    const auto id = static_cast<size_t>(entity.id());
+    return id < tracked_.size() && tracked_[id].cell != NO_CELL;
+  }
+
+  size_t size() const { return size_; }
+  double cell_size(int level = 0) const { return levels_[level].cell_size; }
+
+  // Number of entities in the cell of the given level containing location.
+  int cell_count(int level, const math::Vec2d& location) const {
+    const auto& l = levels_[level];
+    return l.counts[(row(location.y()) >> l.shift) * l.columns + (column(location.x()) >> l.shift)];
+  }
+
+  // Call func(const T&) for every entity whose center is within range of origin.
+  template<typename Func>
+  void for_each_in_range(const math::Vec2d& origin, double range, Func func) const {
+    const auto range_squared = range * range;
+    walk_range(origin, range,
+      [&](int level, int column, int row) {
+        for_each_below(level, column, row, func);
+        return true;
+      },
+      [&](int index) {
+        for (const auto& member : cells_[index]) {
+          if ((member.entity->current_location() - origin).length_squared() <= range_squared) {
+            func(*member.entity);
+          }
+        }
+        return true;
+      });
+  }
+
+  // Returns all entities whose center is within range of origin.
+  std::vector<const T*> in_range(const math::Vec2d& origin, double range) const {
+    std::vector<const T*> found;
+    for_each_in_range(origin, range, [&found](const T& entity) {
+      found.push_back(&entity);
+    });
+    return found;
+  }
+
+  // Number of entities whose center is within range of origin. Cells inside
+  // the circle contribute their count, only cells on its edge are scanned.
+  size_t count_in_range(const math::Vec2d& origin, double range) const {
+    const auto range_squared = range * range;
+    size_t count = 0;
+    walk_range(origin, range,
+      [&](int level, int column, int row) {
+        count += levels_[level].counts[row * levels_[level].columns + column];
+        return true;
+      },
+      [&](int index) {
+        for (const auto& member : cells_[index]) {
+          if ((member.entity->current_location() - origin).length_squared() <= range_squared) {
+            count++;
+          }
+        }
+        return true;
+      });
+    return count;
+  }
+
+  // Whether any entity's center is within range of origin. Stops at the
+  // first hit, usually a non-empty cell inside the circle.
+  bool any_in_range(const math::Vec2d& origin, double range) const {
+    const auto range_squared = range * range;
+    bool found = false;
+    walk_range(origin, range,
+      [&](int, int, int) {
+        found = true;
+        return false;
+      },
+      [&](int index) {
+        for (const auto& member : cells_[index]) {
+          if ((member.entity->current_location() - origin).length_squared() <= range_squared) {
+            found = true;
+            return false;
+          }
+        }
+        return true;
+      });
+    return found;
+  }
+
+private:
+  static constexpr int NO_CELL = -1;
+
+  // Cell bounds are widened by this much before they are compared against a
+  // query, so a member rounded into a neighbouring cell is never pruned.
+  static constexpr double EDGE_SLACK = 1e-6;
+
+  struct Member {
+    const T* entity;
+    int id;
+  };
+
+  struct Location {
+    int cell;
+    int slot;
+  };
+
+  struct Level {
+    double cell_size;
+    int shift;
+    int scale;
+    int columns;
+    int rows;
+    std::vector<int> counts;
+    // Cell bounds by column and row, widened by EDGE_SLACK. Entities off the
+    // map are clamped into the edge cells, so edge cells reach out to
+    // infinity.
+    std::vector<double> low_x;
+    std::vector<double> high_x;
+    std::vector<double> low_y;
+    std::vector<double> high_y;
+  };
+
+  static void set_bounds(int cells, double size, std::vector<double>& low, std::vector<double>& high) {
+    low.resize(cells);
+    high.resize(cells);
+    for (int i = 0; i < cells; i++) {
+      low[i] = i * size - EDGE_SLACK;
+      high[i] = (i + 1) * size + EDGE_SLACK;
+    }
+    low.front() = -std::numeric_limits<double>::infinity();
+    high.back() = std::numeric_limits<double>::infinity();
+  }
+
+  void add_to_cell(int index, const T& entity) {
+    const auto id = static_cast<size_t>(entity.id());
+    if (id >= tracked_.size()) {
+      tracked_.resize(id + 1, { NO_CELL, 0 });
+    }
+    auto& cell = cells_[index];
+    tracked_[id] = { index, static_cast<int>(cell.size()) };
+    cell.push_back({ &entity, static_cast<int>(id) });
+    adjust_counts(index, 1);
+  }
+
+  // Cell order does not matter, so fill the hole with the last member.
+  void remove_from_cell(int id) {
+    auto& location = tracked_[id];
+    auto& cell = cells_[location.cell];
+    cell[location.slot] = cell.back();
+    tracked_[cell.back().id].slot = location.slot;
+    cell.pop_back();
+    adjust_counts(location.cell, -1);
+    location.cell = NO_CELL;
+  }
+
+  void adjust_counts(int index, int delta) {
+    const int fine_column = index % levels_[0].columns;
+    const int fine_row = index / levels_[0].columns;
+    for (auto& level : levels_) {
+      level.counts[(fine_row >> level.shift) * level.columns + (fine_column >> level.shift)] += delta;
+    }
+  }
+
+  // Clamp to the grid so that queries hanging off the edge of the map are safe.
+  int column(double x) const {
+    return std::min(levels_[0].columns - 1, std::max(0, static_cast<int>(std::floor(x / levels_[0].cell_size))));
+  }
+
+  int row(double y) const {
+    return std::min(levels_[0].rows - 1, std::max(0, static_cast<int>(std::floor(y / levels_[0].cell_size))));
+  }
+
+  int cell_index(const math::Vec2d& location) const {
+    return row(location.y()) * levels_[0].columns + column(location.x());
+  }
+
+  // Visit the non-empty cells that touch the query circle, from the coarsest
+  // level whose cells are no wider than the range. Coarser cells could never
+  // be inside the circle, so they would only add a level of descent.
+  //
+  // Cells entirely inside the circle go to covered(level, column, row)
+  // without descending further. Fine cells in the query bounds under any
+  // other cell go to partial(index), which must test each member. Either
+  // returns false to end the walk.
+  //
+  // The descent keeps its own stack rather than recursing, so the callbacks
+  // stay inline in the caller's loop.
+  template<typename Covered, typename Partial>
+  void walk_range(const math::Vec2d& origin, double range, Covered covered, Partial partial) const {
+    const auto range_squared = range * range;
+    const int min_column = column(origin.x() - range);
+    const int max_column = column(origin.x() + range);
+    const int min_row = row(origin.y() - range);
+    const int max_row = row(origin.y() + range);
+
+    int start = 0;
+    while (start + 1 < LEVELS && levels_[start + 1].cell_size <= range) {
+      start++;
+    }
+
+    // Nothing to skip or count wholesale, so scan like a flat grid.
+    if (start == 0) {
+      for (int y = min_row; y <= max_row; y++) {
+        for (int x = min_column; x <= max_column; x++) {
+          if (!partial(y * levels_[0].columns + x)) {
+            return;
+          }
+        }
+      }
+      return;
+    }
+
+    struct Cell {
+      int level;
+      int column;
+      int row;
+    };
+    // Each level pushes at most BRANCHING x BRANCHING children at a time.
+    std::array<Cell, (LEVELS - 1) * BRANCHING * BRANCHING + 1> stack;
+
+    const auto& top = levels_[start];
+    for (int top_y = min_row >> top.shift; top_y <= max_row >> top.shift; top_y++) {
+      for (int top_x = min_column >> top.shift; top_x <= max_column >> top.shift; top_x++) {
+        int size = 0;
+        stack[size++] = { start, top_x, top_y };
+        while (size > 0) {
+          const auto cell = stack[--size];
+          const auto& l = levels_[cell.level];
+          if (l.counts[cell.row * l.columns + cell.column] == 0) {
+            continue;
+          }
+
+          const double to_low_x = origin.x() - l.low_x[cell.column];
+          const double to_high_x = l.high_x[cell.column] - origin.x();
+          const double to_low_y = origin.y() - l.low_y[cell.row];
+          const double to_high_y = l.high_y[cell.row] - origin.y();
+          const double near_x = std::max(0.0, std::max(-to_low_x, -to_high_x));
+          const double near_y = std::max(0.0, std::max(-to_low_y, -to_high_y));
+          if (near_x * near_x + near_y * near_y > range_squared) {
+            continue;
+          }
+          const double far_x = std::max(to_low_x, to_high_x);
+          const double far_y = std::max(to_low_y, to_high_y);
+          if (far_x * far_x + far_y * far_y <= range_squared) {
+            if (!covered(cell.level, cell.column, cell.row)) {
+              return;
+            }
+            continue;
+          }
+
+          const auto& child = levels_[cell.level - 1];
+          const int child_min_y = std::max(cell.row * BRANCHING, min_row >> child.shift);
+          const int child_max_y = std::min(cell.row * BRANCHING + BRANCHING - 1, max_row >> child.shift);
+          const int child_min_x = std::max(cell.column * BRANCHING, min_column >> child.shift);
+          const int child_max_x = std::min(cell.column * BRANCHING + BRANCHING - 1, max_column >> child.shift);
+          // Testing a fine cell costs about as much as scanning it.
+          if (cell.level == 1) {
+            for (int y = child_min_y; y <= child_max_y; y++) {
+              for (int x = child_min_x; x <= child_max_x; x++) {
+                if (!partial(y * child.columns + x)) {
+                  return;
+                }
+              }
+            }
+            continue;
+          }
+          for (int y = child_min_y; y <= child_max_y; y++) {
+            for (int x = child_min_x; x <= child_max_x; x++) {
+              stack[size++] = { cell.level - 1, x, y };
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Call func for every member under a cell, no distance checks needed.
+  template<typename Func>
+  void for_each_below(int level, int column, int row, Func& func) const {
+    const auto& fine = levels_[0];
+    const int scale = levels_[level].scale;
+    const int max_y = std::min((row + 1) * scale, fine.rows);
+    const int max_x = std::min((column + 1) * scale, fine.columns);
+    for (int y = row * scale; y < max_y; y++) {
+      for (int x = column * scale; x < max_x; x++) {
+        for (const auto& member : cells_[y * fine.columns + x]) {
+          func(*member.entity);
+        }
+      }
+    }
+  }
+
+  std::array<Level, LEVELS> levels_;
+  size_t size_ = 0;
+  // Members of the finest level.
+  std::vector<std::vector<Member>> cells_;
+  // Indexed by entity id.
+  std::vector<Location> tracked_;
+};
+
+template<typename T>
+constexpr int HierarchicalGrid<T>::LEVELS;
+
+template<typename T>
+constexpr int HierarchicalGrid<T>::BRANCHING_SHIFT;
+
+template<typename T>
+constexpr int HierarchicalGrid<T>::BRANCHING;
+
+template<typename T>
+constexpr int HierarchicalGrid<T>::NO_CELL;
+
+template<typename T>
+constexpr double HierarchicalGrid<T>::EDGE_SLACK;
+
+}
+}
+
+#endif // !RAF_GAME_HIERARCHICAL_GRID_H_
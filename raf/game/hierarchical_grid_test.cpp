@@ -0,0 +1,286 @@
+#include "hierarchical_grid.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using raf::game::EntityId;
+using raf::game::HierarchicalGrid;
+using raf::game::Ship;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+
+static std::vector<EntityId> ids_of(const std::vector<const Ship*>& ships) {
+  std::vector<EntityId> ids;
+  for (const auto* ship : ships) {
+    ids.push_back(ship->id());
+  }
+  std::sort(std::begin(ids), std::end(ids));
+  return ids;
+}
+
+static std::vector<EntityId> linear_scan(const std::map<EntityId, Ship>& ships, const Vec2d& origin, double range) {
+  std::vector<EntityId> ids;
+  for (const auto& e : ships) {
+    if ((e.second.current_location() - origin).length_squared() <= range * range) {
+      ids.push_back(e.first);
+    }
+  }
+  return ids;
+}
+
+static std::map<EntityId, Ship> random_ships(int count, const Vec2i& dimensions, std::mt19937& rng) {
+  std::uniform_real_distribution<double> x(0.5, dimensions.x() - 0.5);
+  std::uniform_real_distribution<double> y(0.5, dimensions.y() - 0.5);
+  std::map<EntityId, Ship> ships;
+  for (EntityId id = 0; id < count; id++) {
+    ships.emplace(id, Ship(id, id % 4, Vec2d{ x(rng), y(rng) }, 0.5, 255));
+  }
+  return ships;
+}
+
+// Move every ship up to a full thrust in a random direction, staying on the map.
+static void random_walk(std::map<EntityId, Ship>& ships, const Vec2i& dimensions, std::mt19937& rng) {
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  std::uniform_real_distribution<double> speed(0, 7);
+  for (auto& e : ships) {
+    const auto a = angle(rng);
+    const auto v = speed(rng);
+    const auto loc = e.second.current_location();
+    e.second.update_location({
+      std::min(dimensions.x() - 0.5, std::max(0.5, loc.x() + v * std::cos(a))),
+      std::min(dimensions.y() - 0.5, std::max(0.5, loc.y() + v * std::sin(a)))
+    });
+  }
+}
+
+TEST(raf_hierarchical_grid, empty)
+{
+  HierarchicalGrid<Ship> grid(Vec2i(240, 160));
+  ASSERT_EQ(0, grid.size());
+  ASSERT_TRUE(grid.in_range({ 120, 80 }, 100).empty());
+  ASSERT_EQ(0, grid.count_in_range({ 120, 80 }, 1000));
+  ASSERT_FALSE(grid.any_in_range({ 120, 80 }, 1000));
+}
+
+TEST(raf_hierarchical_grid, level_counts)
+{
+  HierarchicalGrid<Ship> grid(Vec2i(384, 256));
+  ASSERT_DOUBLE_EQ(16, grid.cell_size(0));
+  ASSERT_DOUBLE_EQ(64, grid.cell_size(1));
+  ASSERT_DOUBLE_EQ(256, grid.cell_size(2));
+
+  const Ship a(0, 0, { 1, 1 }, 0.5, 255);
+  const Ship b(1, 0, { 40, 40 }, 0.5, 255);
+  const Ship c(2, 0, { 200, 200 }, 0.5, 255);
+  grid.insert(a);
+  grid.insert(b);
+  grid.insert(c);
+
+  ASSERT_EQ(1, grid.cell_count(0, { 1, 1 }));
+  ASSERT_EQ(2, grid.cell_count(1, { 1, 1 }));
+  ASSERT_EQ(3, grid.cell_count(2, { 1, 1 }));
+  ASSERT_EQ(0, grid.cell_count(2, { 300, 1 }));
+
+  grid.remove(b);
+  ASSERT_EQ(1, grid.cell_count(1, { 1, 1 }));
+  ASSERT_EQ(2, grid.cell_count(2, { 1, 1 }));
+}
+
+TEST(raf_hierarchical_grid, matches_linear_scan)
+{
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> range(0, 120);
+  for (const auto& dimensions : { Vec2i(240, 160), Vec2i(384, 256), Vec2i(250, 170) }) {
+    const auto ships = random_ships(600, dimensions, rng);
+    HierarchicalGrid<Ship> grid(dimensions);
+    for (const auto& e : ships) {
+      grid.insert(e.second);
+    }
+
+    std::uniform_real_distribution<double> x(-20, dimensions.x() + 20);
+    std::uniform_real_distribution<double> y(-20, dimensions.y() + 20);
+    for (int i = 0; i < 300; i++) {
+      const Vec2d origin(x(rng), y(rng));
+      const double r = range(rng);
+      const auto expected = linear_scan(ships, origin, r);
+      ASSERT_EQ(expected, ids_of(grid.in_range(origin, r))) << origin << " " << r;
+      ASSERT_EQ(expected.size(), grid.count_in_range(origin, r)) << origin << " " << r;
+      ASSERT_EQ(!expected.empty(), grid.any_in_range(origin, r)) << origin << " " << r;
+    }
+  }
+}
+
+// Members exactly on the query circle or on cell boundaries.
+TEST(raf_hierarchical_grid, boundaries)
+{
+  const Vec2i dimensions(240, 160);
+  std::map<EntityId, Ship> ships;
+  EntityId id = 0;
+  for (double x = 0; x <= 240; x += 4) {
+    for (double y = 0; y <= 160; y += 4) {
+      ships.emplace(id, Ship(id, 0, Vec2d{ x, y }, 0.5, 255));
+      id++;
+    }
+  }
+  HierarchicalGrid<Ship> grid(dimensions);
+  for (const auto& e : ships) {
+    grid.insert(e.second);
+  }
+
+  const Vec2d origins[] = { { 0, 0 }, { 32, 32 }, { 128, 64 }, { 240, 160 }, { 64, 96 } };
+  const double ranges[] = { 0.0, 4.0, 8.0, 32.0, 40.0, 64.0, 128.0, 300.0 };
+  for (const auto& origin : origins) {
+    for (const auto range : ranges) {
+      const auto expected = linear_scan(ships, origin, range);
+      ASSERT_EQ(expected, ids_of(grid.in_range(origin, range))) << origin << " " << range;
+      ASSERT_EQ(expected.size(), grid.count_in_range(origin, range)) << origin << " " << range;
+    }
+  }
+}
+
+TEST(raf_hierarchical_grid, off_map_entities)
+{
+  HierarchicalGrid<Ship> grid(Vec2i(240, 160));
+  const Ship outside(0, 0, { -30, 200 }, 0.5, 255);
+  grid.insert(outside);
+
+  ASSERT_EQ(1, grid.in_range({ -30, 200 }, 1).size());
+  ASSERT_EQ(1, grid.count_in_range({ -25, 195 }, 10));
+  ASSERT_TRUE(grid.any_in_range({ -30, 190 }, 10));
+  ASSERT_FALSE(grid.any_in_range({ 0, 160 }, 10));
+}
+
+TEST(raf_hierarchical_grid, update_matches_rebuild)
+{
+  const Vec2i dimensions(384, 256);
+  std::mt19937 rng(1);
+  auto ships = random_ships(500, dimensions, rng);
+
+  HierarchicalGrid<Ship> incremental(dimensions);
+  for (const auto& e : ships) {
+    incremental.update(e.second);
+  }
+
+  for (int turn = 0; turn < 50; turn++) {
+    random_walk(ships, dimensions, rng);
+    incremental.remove(ships.begin()->second);
+    ships.erase(ships.begin());
+    for (const auto& e : ships) {
+      incremental.update(e.second);
+    }
+
+    ASSERT_EQ(ships.size(), incremental.size());
+    const Vec2d origin(turn * 7.0, turn * 5.0);
+    ASSERT_EQ(linear_scan(ships, origin, 40), ids_of(incremental.in_range(origin, 40)));
+    ASSERT_EQ(ships.size(), incremental.count_in_range({ 192, 128 }, 1000));
+  }
+
+  incremental.clear();
+  ASSERT_EQ(0, incremental.size());
+  ASSERT_EQ(0, incremental.cell_count(2, { 1, 1 }));
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(raf_hierarchical_grid, DISABLED_benchmark_against_linear_scan)
+{
+  using Clock = std::chrono::steady_clock;
+  const Vec2i dimensions(384, 256);
+  // Collision lookahead, weapon lookahead and a 13 turn search.
+  const double ranges[] = { 16.0, 21.0, 85.0 };
+
+  for (const int count : { 200, 1000, 3000 }) {
+    std::mt19937 rng(count);
+    const auto ships = random_ships(count, dimensions, rng);
+    std::vector<const Ship*> all;
+    HierarchicalGrid<Ship> hierarchical(dimensions);
+    for (const auto& e : ships) {
+      all.push_back(&e.second);
+      hierarchical.insert(e.second);
+    }
+
+    for (const auto range : ranges) {
+      size_t linear_found = 0, hierarchical_found = 0, counted = 0;
+      auto start = Clock::now();
+      for (const auto& e : ships) {
+        const auto origin = e.second.current_location();
+        for (const auto* ship : all) {
+          if ((ship->current_location() - origin).length_squared() <= range * range) {
+            linear_found++;
+          }
+        }
+      }
+      const auto linear_time = Clock::now() - start;
+
+      start = Clock::now();
+      for (const auto& e : ships) {
+        hierarchical.for_each_in_range(e.second.current_location(), range, [&](const Ship&) { hierarchical_found++; });
+      }
+      const auto hierarchical_time = Clock::now() - start;
+
+      start = Clock::now();
+      for (const auto& e : ships) {
+        counted += hierarchical.count_in_range(e.second.current_location(), range);
+      }
+      const auto count_time = Clock::now() - start;
+
+      ASSERT_EQ(linear_found, hierarchical_found);
+      ASSERT_EQ(linear_found, counted);
+
+      const auto per_query = [count](Clock::duration d) {
+        return std::chrono::duration<double, std::nano>(d).count() / count;
+      };
+      std::cout << count << " ships, range " << range << ": linear " << per_query(linear_time)
+        << "ns, hierarchical " << per_query(hierarchical_time)
+        << "ns, count " << per_query(count_time) << "ns" << std::endl;
+    }
+  }
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(raf_hierarchical_grid, DISABLED_benchmark_update_vs_rebuild)
+{
+  using Clock = std::chrono::steady_clock;
+  const Vec2i dimensions(384, 256);
+  const int turns = 300;
+
+  for (const int count : { 200, 1000, 3000 }) {
+    std::mt19937 rng(count);
+    auto ships = random_ships(count, dimensions, rng);
+    HierarchicalGrid<Ship> incremental(dimensions);
+    HierarchicalGrid<Ship> rebuilt(dimensions);
+    Clock::duration update_time{}, rebuild_time{};
+
+    for (int turn = 0; turn < turns; turn++) {
+      random_walk(ships, dimensions, rng);
+
+      auto start = Clock::now();
+      for (const auto& e : ships) {
+        incremental.update(e.second);
+      }
+      update_time += Clock::now() - start;
+
+      start = Clock::now();
+      rebuilt.clear();
+      for (const auto& e : ships) {
+        rebuilt.insert(e.second);
+      }
+      rebuild_time += Clock::now() - start;
+    }
+    ASSERT_EQ(rebuilt.size(), incremental.size());
+    ASSERT_EQ(ids_of(rebuilt.in_range({ 192, 128 }, 60)), ids_of(incremental.in_range({ 192, 128 }, 60)));
+
+    const auto per_turn = [turns](Clock::duration d) {
+      return std::chrono::duration<double, std::micro>(d).count() / turns;
+    };
+    std::cout << count << " ships: update " << per_turn(update_time)
+      << "us/turn, rebuild " << per_turn(rebuild_time) << "us/turn" << std::endl;
+  }
+}
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "../stdlib_util.h"
+#include "../math/vec2x4.hpp"
 // Production mechanics
 //
 // 72 units to produce a ship
@@ -184,24 +185,18 @@ hlt::Move from_velocity(const game::Entity& entity, const math::Velocity& vel) {
 // Take a new snapshot of data and apply it to existing persistant data
 // If the new entity does not exist then create it, else update it.
 void MapState::update(const hlt::Planet& planet) {
-  const auto& p = planets_.insert({ planet.entity_id, planet });
-  if (!p.second) {
-    p.first->second.update(planet);
-  }
-
-  mark_valid(p.first->second);
+  const auto p = planets_.upsert(planet.entity_id, planet);
+  mark_valid(*p.first);
 }
 
 void MapState::update(const hlt::Ship& ship) {
-  const auto &s = (ship.owner_id == local_player_id_) ?
-    player_ships_.insert({ ship.entity_id, ship }) :
-    enemy_ships_.insert({ ship.entity_id, ship });
-
-  if (!s.second) {
-    s.first->second.update(ship);
-  }
+  const auto s = (ship.owner_id == local_player_id_) ?
+    player_ships_.upsert(ship.entity_id, ship) :
+    enemy_ships_.upsert(ship.entity_id, ship);
 
-  mark_valid(s.first->second);
+  // Stored ships never move, so the grid can keep pointing at them.
+  ship_grid_.update(*s.first);
+  mark_valid(*s.first);
 }
 
 void MapState::mark_valid(const Planet& planet) {
@@ -229,9 +224,17 @@ bool MapState::can_dock_more(game::EntityId planet_id) const {
 }
 
 void MapState::prune_dead_entities() {
-  map_erase_if(player_ships_, [this](const Ship& ship) { return !is_valid(ship); });
-  map_erase_if(enemy_ships_, [this](const Ship& ship) { return !is_valid(ship); });
-  map_erase_if(planets_, [this](const Planet& planet) { return !is_valid(planet); });
+  const auto is_dead = [this](const Ship& ship) {
+    if (is_valid(ship)) {
+      return false;
+    }
+    ship_grid_.remove(ship);
+    approaches_.remove(ship);
+    return true;
+  };
+  player_ships_.erase_if(is_dead);
+  enemy_ships_.erase_if(is_dead);
+  planets_.erase_if([this](const Planet& planet) { return !is_valid(planet); });
 }
 
 //
@@ -248,8 +251,9 @@ public:
     double dock_radius,
     PlayerId player_id,
     const Planet& planet,
-    const std::vector<Planet>& planets,
-    const std::vector<Ship>& ships,
+    const FrameVector<Planet>& planets,
+    const PlanetTravelTable& travel,
+    const navigation::AreaSearch& area,
     int map_width,
     int map_height) :
     attack_radius_(attack_radius),
@@ -257,13 +261,12 @@ public:
     planet_id_(planet.id()),
     player_id_(player_id)
   {
-    const auto spawn = spawn_point(planet, map_width, map_height);
     docking_score = planet.total_docking_spots();
     const auto center_point = math::Vec2d(map_width / 2, map_height / 2);
     distance_to_center_ = ((planet.current_location() - center_point).length() / center_point.length()) * 5.0f;
     distance_to_center_ *= distance_to_center_;
     for (const auto& target : planets) {
-      const auto distance = target.distance_to(spawn);
+      const auto distance = travel.spawn_distance(planet.id(), target.id());
 
       if (distance <= 28.0f) {
         const auto num_spots = target.total_docking_spots();
@@ -277,39 +280,28 @@ public:
 
     raf::Log("planet_id_=", planet_id_, ", docking_score=", docking_score, ", distance_to_center=", distance_to_center_);
 
-    for (const auto& target : ships) {
-      const auto distance = planet.distance_to(target);
-      if (distance <= attack_radius) {
-        if (target.owner() == player_id_) {
-          friendly_in_attack_radius.push_back(target.id());
-        } else {
-          enemy_in_attack_radius.push_back(target.id());
-        }
-      }
+    const auto in_attack_radius = area.in_circle(planet.current_location(), attack_radius);
+    friendly_in_attack_radius = in_attack_radius.ships(navigation::Side::Friendly);
+    enemy_in_attack_radius = in_attack_radius.ships(navigation::Side::Enemy);
 
-      if (distance <= dock_radius) {
-        if (target.owner() == player_id_) {
-          friendly_in_dock_radius.push_back(target.id());
-        } else {
-          enemy_in_dock_radius.push_back(target.id());
-        }
-      }
-    }
+    const auto in_dock_radius = area.in_circle(planet.current_location(), dock_radius);
+    friendly_in_dock_radius = in_dock_radius.ships(navigation::Side::Friendly);
+    enemy_in_dock_radius = in_dock_radius.ships(navigation::Side::Enemy);
   }
 
   double attack_ratio() const {
-    const auto friendly = friendly_in_attack_radius.size();
-    const auto enemy = enemy_in_attack_radius.size();
+    const auto friendly = friendly_in_attack_radius;
+    const auto enemy = enemy_in_attack_radius;
     auto sum = friendly + enemy;
-    return sum > 0 ? friendly / sum : 0.0;
+    return sum > 0 ? static_cast<double>(friendly) / sum : 0.0;
   }
 
   double dock_ratio() const {
-    const auto friendly = friendly_in_dock_radius.size();
-    const auto enemy = enemy_in_dock_radius.size();
+    const auto friendly = friendly_in_dock_radius;
+    const auto enemy = enemy_in_dock_radius;
     auto sum = friendly + enemy;
     // If there is nothing in the dock ratio return 1.0, i.e safe.
-    return sum > 0 ? friendly / sum : 1.0;
+    return sum > 0 ? static_cast<double>(friendly) / sum : 1.0;
   }
 
   int score_based_on_distance_in_turns(int turns) const {
@@ -327,23 +319,26 @@ public:
   const EntityId planet_id_;
   const PlayerId player_id_;
   double distance_to_center_;
-  std::vector<EntityId> enemy_in_attack_radius;
-  std::vector<EntityId> friendly_in_attack_radius;
-  std::vector<EntityId> enemy_in_dock_radius;
-  std::vector<EntityId> friendly_in_dock_radius;
+  // Ship counts, see AreaSearch::in_circle.
+  int enemy_in_attack_radius;
+  int friendly_in_attack_radius;
+  int enemy_in_dock_radius;
+  int friendly_in_dock_radius;
 };
 
-std::vector<PlanetPerimeterInfo> get_planet_info(
-  const std::vector<game::Planet>& planets,
-  const std::vector<game::Ship>& ships,
+FrameVector<PlanetPerimeterInfo> get_planet_info(
+  const FrameVector<game::Planet>& planets,
+  const PlanetTravelTable& travel,
+  const navigation::AreaSearch& area,
   game::PlayerId player_id,
   double threat_radius,
   double dock_radius,
   int map_width,
   int map_height) {
-  std::vector<PlanetPerimeterInfo> planet_info;
+  FrameVector<PlanetPerimeterInfo> planet_info;
+  planet_info.reserve(planets.size());
   for (const auto& planet : planets) {
-    PlanetPerimeterInfo info(threat_radius, dock_radius, player_id, planet, planets, ships, map_width, map_height);
+    PlanetPerimeterInfo info(threat_radius, dock_radius, player_id, planet, planets, travel, area, map_width, map_height);
     planet_info.emplace_back(info);
   }
 
@@ -352,13 +347,13 @@ std::vector<PlanetPerimeterInfo> get_planet_info(
 
 
 std::vector<game::Planet> dockable_planets(
-  const std::map<game::EntityId, game::Planet>& planets,
+  const EntityStore<game::Planet>& planets,
   game::PlayerId player_id) {
   std::vector<game::Planet> dockable;
 
-  raf::transform_if(
-    planets.cbegin(),
-    planets.cend(),
+  std::copy_if(
+    std::begin(planets),
+    std::end(planets),
     std::back_inserter(dockable),
     [player_id](const game::Planet& planet) {
     return game::is_dockable(planet, player_id);
@@ -368,13 +363,13 @@ std::vector<game::Planet> dockable_planets(
 }
 
 std::vector<game::Planet> opponent_planets(
-  const std::map<game::EntityId, game::Planet>& planets,
+  const EntityStore<game::Planet>& planets,
   game::PlayerId player_id) {
   std::vector<game::Planet> opponent_owned;
 
-  raf::transform_if(
-    planets.cbegin(),
-    planets.cend(),
+  std::copy_if(
+    std::begin(planets),
+    std::end(planets),
     std::back_inserter(opponent_owned),
     [player_id](const game::Planet& planet) {
     return game::is_owned_by_opponent(planet, player_id);
@@ -383,59 +378,83 @@ std::vector<game::Planet> opponent_planets(
   return opponent_owned;
 }
 
-std::vector<Ship> find_movable_ships(
-  const std::map<EntityId, Ship>& ships,
-  hlt::PlayerId local_player_id)
+// Pair up ships attacking the same target so they arrive together, see
+// process_attack().
+constexpr bool COORDINATE_ATTACKS = true;
+// Attackers further apart than this go in alone, four turns to meet.
+constexpr double ATTACK_PARTNER_RANGE = 28.0;
+
+// Convert a distance in turns into the largest center to center distance
+// that still satisfies Entity::distance_min_turns() <= turns.
+// Padded by a unit so grid queries never miss a borderline entity; callers
+// still apply the exact turn check to the results.
+static double search_radius_for_turns(int turns) {
+  return (turns - 1) * constants::MAX_SPEED + 1.0;
+}
+
+// Grid queries return ships in cell order. Callers pick from the front of
+// these lists after unstable sorts, so restore id order to keep decisions
+// independent of the grid layout.
+static void sort_by_id(FrameVector<Ship>& ships) {
+  std::sort(std::begin(ships), std::end(ships), [](const Ship& a, const Ship& b) {
+    return a.id() < b.id();
+  });
+}
+
+FrameVector<Ship> find_movable_ships(
+  const Ship& target,
+  const HierarchicalGrid<Ship>& ships,
+  hlt::PlayerId local_player_id,
+  int max_distance_in_turns)
 {
-  std::vector<Ship> movable;
-  for (const auto &e : ships) {
-    const auto &ship = e.second;
+  FrameVector<Ship> movable;
+  const auto range = search_radius_for_turns(max_distance_in_turns);
+  ships.for_each_in_range(target.current_location(), range, [&](const Ship& ship) {
     // If it isn't ours, we can't move it
     if (ship.owner() != local_player_id) {
-      continue;
+      return;
     }
 
     // If it isn't undocked we cant't move it
     if (!ship.is_undocked()) {
-      continue;
+      return;
     }
 
     if (!ship.is_alive()) {
-      continue;
+      return;
+    }
+
+    if (target.distance_min_turns(ship) > max_distance_in_turns) {
+      return;
     }
     movable.push_back(ship);
-  }
+  });
+  sort_by_id(movable);
   return movable;
 }
 
-std::vector<Ship> find_enemy_ships(
-  const std::map<EntityId, Ship>& ships,
+FrameVector<Ship> find_enemy_ships(
+  const EntityStore<Ship>& ships,
   hlt::PlayerId local_player_id)
 {
-  std::vector<Ship> enemy_ships;
-  for (const auto &e : ships) {
-    const auto &ship = e.second;
-    if (ship.owner() == local_player_id) {
-      continue;
-    }
-
-    if (!ship.is_alive()) {
-      continue;
-    }
-    enemy_ships.push_back(ship);
-  }
-  return enemy_ships;
+  return find_enemy_ships(ships, local_player_id, [](const Ship&) { return true; });
 }
 
-std::vector<Ship> find_threats_to_ship(
+// Our ship id to an enemy ship within DOCKED_THREAT_RANGE of it, sorted.
+using ThreatCandidates = FrameVector<std::pair<EntityId, const Ship*>>;
+
+// candidates must hold every enemy within search_radius_for_turns() of target.
+FrameVector<Ship> find_threats_to_ship(
   const Ship& target,
-  const std::map<EntityId, Ship>& ships,
+  const ThreatCandidates& candidates,
   hlt::PlayerId local_player_id,
   int max_distance_in_turns)
 {
-  std::vector<Ship> threats;
-  for (const auto &e : ships) {
-    const auto &ship = e.second;
+  FrameVector<Ship> threats;
+  const auto first = std::lower_bound(std::begin(candidates), std::end(candidates), target.id(),
+    [](const std::pair<EntityId, const Ship*>& candidate, EntityId id) { return candidate.first < id; });
+  for (auto it = first; it != std::end(candidates) && it->first == target.id(); ++it) {
+    const auto& ship = *it->second;
     if (ship.owner() == local_player_id) {
       continue;
     }
@@ -454,39 +473,126 @@ std::vector<Ship> find_threats_to_ship(
     }
     threats.push_back(ship);
   }
+  sort_by_id(threats);
   return threats;
 }
 
 
-std::vector<Ship> ships_within_range(
+FrameVector<Ship> ships_within_range(
   const Ship& target,
-  const std::map<EntityId, Ship>& ships,
+  const HierarchicalGrid<Ship>& ships,
   hlt::PlayerId player_id,
   int max_distance_in_turns)
 {
-  std::vector<Ship> nearby;
-  for (const auto &e : ships) {
-    const auto &ship = e.second;
+  FrameVector<Ship> nearby;
+  const auto range = search_radius_for_turns(max_distance_in_turns);
+  ships.for_each_in_range(target.current_location(), range, [&](const Ship& ship) {
     if (ship.owner() == player_id) {
-      continue;
+      return;
     }
 
     if (!ship.is_alive()) {
-      continue;
+      return;
     }
 
     if (ship.distance_min_turns(target) > max_distance_in_turns) {
-      continue;
+      return;
     }
     nearby.push_back(ship);
-  }
+  });
+  sort_by_id(nearby);
   return nearby;
 }
 
+void MapState::build_area_search() {
+  area_search_.clear();
+  for (const auto& ship : player_ships_) {
+    area_search_.add(ship, navigation::Side::Friendly);
+  }
+  for (const auto& ship : enemy_ships_) {
+    area_search_.add(ship, navigation::Side::Enemy);
+  }
+  area_search_.integrate();
+}
+
+math::Vec2d MapState::clear_of_planets(const math::Vec2d& point) const {
+  const double clearance = constants::SHIP_RADIUS + constants::FORECAST_FUDGE_FACTOR;
+  const auto nearest = planet_field_.nearest(point);
+  if (nearest.id == INVALID_ENTITIY_ID || nearest.surface_distance >= clearance) {
+    return point;
+  }
+  // Straight out from the center to just past the surface.
+  const auto& planet = planets_.at(nearest.id);
+  const auto offset = point - planet.current_location();
+  const auto length = offset.length();
+  if (length == 0.0) {
+    return planet.current_location() + math::Vec2d(planet.radius() + clearance, 0.0);
+  }
+  return planet.current_location() + offset * ((planet.radius() + clearance) / length);
+}
+
+void MapState::pre_game() {
+  // Planets never move, so their geometry only needs bucketing once.
+  planet_index_.build(planets_);
+  planet_travel_.build(planets_, planet_index_);
+  // Before any ship moves, so the spawns are where they started.
+  symmetry_.detect(planets_, player_ships_, enemy_ships_);
+  planet_field_.build(planets_, symmetry_);
+  rank_opponents_by_home();
+}
+
+void MapState::rank_opponents_by_home() {
+  opponents_by_home_.clear();
+  const auto home = symmetry_.home_planet(local_player_id_);
+  if (home == INVALID_ENTITIY_ID) {
+    return;
+  }
+  std::vector<std::pair<double, PlayerId>> ranked;
+  for_each_opponent([&](PlayerId player) {
+    // On a symmetric map their home is the mirror image of ours.
+    auto theirs = symmetry_.counterpart(home, local_player_id_, player);
+    if (theirs == INVALID_ENTITIY_ID) {
+      theirs = symmetry_.home_planet(player);
+    }
+    if (theirs != INVALID_ENTITIY_ID) {
+      ranked.push_back({ planet_travel_.travel_distance(home, theirs), player });
+    }
+  });
+  std::sort(std::begin(ranked), std::end(ranked));
+  for (const auto& e : ranked) {
+    opponents_by_home_.push_back(e.second);
+  }
+}
+
+PlayerId MapState::nearest_opponent_by_home() const {
+  for (const auto player : opponents_by_home_) {
+    if (valid_players_.count(player)) {
+      return player;
+    }
+  }
+  return INVALID_ENTITIY_ID;
+}
+
 void MapState::pre_frame() {
+  // Last frame's temporaries are all gone by now.
+  auto& arena = frame_arena();
+  raf::Log("Frame arena: ", arena.bytes_allocated(), " bytes allocated, ", arena.peak_bytes(), " peak, ", arena.capacity(), " held");
+  arena.reset();
   queued_moves_.clear();
   pending_paths_.clear();
+  decisions_.clear();
   prune_dead_entities();
+  planet_index_.refresh(planets_);
+  planet_field_.refresh(planets_);
+  approaches_.begin_frame(current_round_);
+  for (const auto& ship : player_ships_) {
+    approaches_.update(ship, ship_grid_);
+  }
+  for (const auto& ship : enemy_ships_) {
+    approaches_.update(ship, ship_grid_);
+  }
+  build_area_search();
+  distances_.build(player_ships_, enemy_ships_, planets_);
   heading_to_planet_.clear();
   heading_to_attack_.clear();
   moved_ships_.clear();
@@ -560,11 +666,10 @@ struct MapResourceInfo {
 };
 
 static MapResourceInfo map_resource_info(
-  const std::map<game::EntityId, game::Planet>& planets) {
+  const EntityStore<game::Planet>& planets) {
   MapResourceInfo info{};
 
-  for (const auto& pair : planets) {
-    const auto &planet = pair.second;
+  for (const auto &planet : planets) {
 
     if (planet.is_owned()) {
       info.owned_planets[planet.owner()]++;
@@ -605,33 +710,39 @@ struct PlayerShipInfo {
   }
 };
 
+// Streams through the store's columns, called once per player per frame.
 static PlayerShipInfo player_ship_info(
-  const std::map<game::EntityId, game::Ship>& ships,
+  const EntityStore<game::Ship>& ships,
   game::PlayerId player_id) {
   // Always zero initialise
   PlayerShipInfo info{};
-  for (const auto& pair : ships) {
-    const auto& ship = pair.second;
-
-    if (ship.owner() != player_id) {
+  const auto& columns = ships.columns();
+  for (size_t i = 0; i < columns.size(); i++) {
+    if (columns.owner[i] != player_id) {
       continue;
     }
 
-    if (ship.is_docked()) {
+    const math::Vec2d location(columns.x[i], columns.y[i]);
+    switch (static_cast<DockingStatus>(columns.docking[i])) {
+    case DockingStatus::Docked:
       info.docked_ships++;
-      info.average_docked_location += ship.current_location();
-    } else if (ship.is_undocked()) {
+      info.average_docked_location += location;
+      break;
+    case DockingStatus::Undocked:
       info.undocked_ships++;
-      info.average_undocked_location += ship.current_location();
-    } else if (ship.is_undocking()) {
+      info.average_undocked_location += location;
+      break;
+    case DockingStatus::Undocking:
       info.undocking_ships++;
-      info.average_docked_location += ship.current_location();
-    } else if (ship.is_docking()) {
+      info.average_docked_location += location;
+      break;
+    case DockingStatus::Docking:
       info.docking_ships++;
-      info.average_docked_location += ship.current_location();
+      info.average_docked_location += location;
+      break;
     }
 
-    info.average_location += ship.current_location();
+    info.average_location += location;
   }
 
   info.average_docked_location /= info.in_docking_state();
@@ -703,8 +814,8 @@ void MapState::run_frame() {
   //}
 
   // Change this to just pass ID's around and dependents can use an API to query data.
-  std::vector<Ship> all_ships = get_all_ships();
-  const auto planets_vector = get_all_planets();
+  const auto all_ships = get_all_ships();
+  const auto all_planets = get_all_planets();
 
   auto map_info = map_resource_info(planets_);
   //auto player_info = player_ship_info(player_ships_, local_player_id_);
@@ -720,7 +831,12 @@ void MapState::run_frame() {
     player_info[e] = player_ship_info(enemy_ships_, e);
   }
 
-  auto nearest_attacking_opponent = nearest_threat_to(player_info, local_player_id_);
+  // Our neighbour on the map while they are still in the game, otherwise
+  // whoever's ships are nearest ours.
+  auto nearest_attacking_opponent = nearest_opponent_by_home();
+  if (nearest_attacking_opponent == INVALID_ENTITIY_ID) {
+    nearest_attacking_opponent = nearest_threat_to(player_info, local_player_id_);
+  }
   //if (nearest_attacking_opponent == INVALID_ENTITIY_ID) {
   //  raf::Log("Inconsistent game state: nearest_attacking_opponent == INVALID_ENTITIY_ID");
   //  return;
@@ -731,11 +847,24 @@ void MapState::run_frame() {
   //  Rank in order of weakness from weakest to strongest
   // Move to weakest first.
 
+  // Most docked ships have no enemy anywhere near them, so only the pairs the
+  // approach queue has within range now are checked.
+  ThreatCandidates threat_candidates;
+  approaches_.for_each_due(current_round_, [&](const navigation::ApproachQueue::Approach& approach) {
+    if (approach.range != navigation::ApproachQueue::Range::Threat) {
+      return;
+    }
+    if (player_ships_.contains(approach.a) && enemy_ships_.contains(approach.b)) {
+      threat_candidates.push_back({ approach.a, &enemy_ships_.at(approach.b) });
+    } else if (player_ships_.contains(approach.b) && enemy_ships_.contains(approach.a)) {
+      threat_candidates.push_back({ approach.b, &enemy_ships_.at(approach.a) });
+    }
+  });
+  std::sort(std::begin(threat_candidates), std::end(threat_candidates));
+  threat_candidates.erase(std::unique(std::begin(threat_candidates), std::end(threat_candidates)), std::end(threat_candidates));
+
   //auto dockable = dockable_planets(planets_, local_player_id_);
-  auto dockable = planets_vector;
-  for (auto &e : player_ships_) {
-    const auto& ship = e.second;
-    auto potential_planets = dockable;
+  for (const auto &ship : player_ships_) {
     raf::Log("ship id ", ship.id());
     if (!ship.is_alive()) {
       raf::Log("Is dead", ship.id());
@@ -744,23 +873,14 @@ void MapState::run_frame() {
 
     if (!ship.is_undocked()) {
       // Check for enemy threats.
-      auto threats = find_threats_to_ship(ship, enemy_ships_, local_player_id_, 4);
+      const auto threats = find_threats_to_ship(ship, threat_candidates, local_player_id_, 4);
 
-      std::sort(
-        std::begin(threats),
-        std::end(threats),
-        [&ship](const Ship& a, const Ship& b) {
-        return ship.distance_to(a) < ship.distance_to(b);
-      });
-
-      for (const auto& threat : threats) {
-        // Calculate the time taken for the threat to reach our docked ship
-        auto threat_distance = threat.distance_min_turns(ship);
-        auto movable = find_movable_ships(player_ships_, local_player_id_);
+      for (NearestOrder nearest_threats(threats, ship.current_location()); !nearest_threats.empty(); ) {
+        const auto& threat = get_ship(nearest_threats.next());
+        // Only consider anything that is near enough to help.
+        auto movable = find_movable_ships(ship, ship_grid_, local_player_id_, 4);
         // Filter anything that has already been moved.
         filter(movable, [this](const Ship&a) { return has_already_moved(a); });
-        // Filter anything that is too far away.
-        filter(movable, [&ship](const Ship&a) { return ship.distance_min_turns(a) > 4; });
 
         // If there are not many ships to use as defence, defend the mid point.
         // Once the ship mass grows attack instead.
@@ -768,11 +888,12 @@ void MapState::run_frame() {
         for (const auto& defender : movable) {
           possibly<math::Velocity> velocity = { { 0,0 }, false };
           if (defend_mid_point) {
-            auto mid_point = (ship.current_location() + threat.current_location()) / 2;
+            // A docked ship hugs its planet, so the mid point can end up inside it.
+            auto mid_point = clear_of_planets((ship.current_location() + threat.current_location()) / 2);
             // standard move
             velocity =
               navigation::navigate_ship_towards_target(
-                planets_vector,
+                planet_index_,
                 all_ships,
                 defender.current_location(),
                 mid_point,
@@ -785,7 +906,7 @@ void MapState::run_frame() {
             // standard move
             velocity =
               navigation::navigate_ship_to_attack(
-                planets_vector,
+                planet_index_,
                 all_ships,
                 defender,
                 threat,
@@ -818,61 +939,50 @@ void MapState::run_frame() {
     //  return ship.distance_to_edge_min_turns(a) > 10 || !can_dock_more(a.id());
     //});
 
-    filter(potential_planets, [&ship, this](const game::Planet& a) {
+    // Copy only the planets this ship may head for, once it is known to need them.
+    FrameVector<Planet> potential_planets;
+    std::copy_if(std::begin(all_planets), std::end(all_planets), std::back_inserter(potential_planets), [this](const game::Planet& a) {
       // if it is owned by us, then use our tracking function
       if (a.is_owned() && a.owner() == local_player_id_) {
-        return !can_dock_more(a.id());
+        return can_dock_more(a.id());
       }
-      return false;
+      return true;
     });
 
-    auto planet_info = get_planet_info(potential_planets, all_ships, local_player_id_, 25.0, 49.0, dimensions_.x(), dimensions_.y());
+    auto planet_info = get_planet_info(potential_planets, planet_travel_, area_search_, local_player_id_, 25.0, 49.0, dimensions_.x(), dimensions_.y());
 
     const auto current_alive_players = num_players();
-    std::sort(
-      std::begin(potential_planets),
-      std::end(potential_planets),
-      [&ship, planet_info, current_alive_players](const game::Planet& a, const game::Planet& b) {
-      // If A is less than B pick A
-      auto a_info = std::find_if(std::begin(planet_info), std::end(planet_info), [a](const PlanetPerimeterInfo& x) {
+    // Score each planet once, rather than twice per comparison.
+    sort_by_key(potential_planets, [this, &ship, &planet_info, current_alive_players](const game::Planet& a) {
+      // Lower scores are picked first.
+      auto a_info = std::find_if(std::begin(planet_info), std::end(planet_info), [&a](const PlanetPerimeterInfo& x) {
         return a.id() == x.planet_id_;
-      });;
-
-      auto b_info = std::find_if(std::begin(planet_info), std::end(planet_info), [b](const PlanetPerimeterInfo& x) {
-        return b.id() == x.planet_id_;
-      });;
+      });
 
-      
-      auto a_score = a_info->score_based_on_distance_in_turns(a.distance_min_turns(ship));
-      auto b_score = b_info->score_based_on_distance_in_turns(b.distance_min_turns(ship));
+      auto a_score = a_info->score_based_on_distance_in_turns(distances_.planet_turns(ship.id(), a.id()));
 
       if (current_alive_players == 4) {
         // Further away planets will have higher scores
         a_score -= a_info->score_based_on_distance_to_center();
-        b_score -= b_info->score_based_on_distance_to_center();
       } else if (current_alive_players == 3) {
       } else if (current_alive_players == 2) {
         //// More central planets will have lower scores
         //a_score += a_info->score_based_on_distance_to_center();
-        //b_score += b_info->score_based_on_distance_to_center();
-      }
-
-      if (a_score < b_score) {
-        return true;
       }
-      return false;
 
-      auto a_factor = ship.distance_to_edge_min_turns(a) + (2 * b.total_docking_spots()) - 1;
-      auto b_factor = ship.distance_to_edge_min_turns(b) + (2 * a.total_docking_spots()) - 1;
-      if (a_factor < b_factor) {
-        return true;
-      } else if (a_factor > b_factor) {
-        // A is further, pick B
-        return false;
-      } else {
-        // Favour the ship with the largest radius.
-        return a.radius() > b.radius();
-      }
+      return a_score;
+
+      //auto a_factor = ship.distance_to_edge_min_turns(a) + (2 * b.total_docking_spots()) - 1;
+      //auto b_factor = ship.distance_to_edge_min_turns(b) + (2 * a.total_docking_spots()) - 1;
+      //if (a_factor < b_factor) {
+      //  return true;
+      //} else if (a_factor > b_factor) {
+      //  // A is further, pick B
+      //  return false;
+      //} else {
+      //  // Favour the ship with the largest radius.
+      //  return a.radius() > b.radius();
+      //}
     });
 
     enum State {
@@ -931,42 +1041,41 @@ void MapState::run_frame() {
       consider_attack = (player_info[local_player_id_].dock_ratio() > .89);
     }
 
-    // TODO: Add lambda to allow filtering on first run.
-    auto potential_targets = find_enemy_ships(enemy_ships_, local_player_id_);
-    filter(
-      potential_targets,
-      [&ship, nearest_attacking_opponent, consider_attack](const Ship& a) {
+    // Only the targets that pass are copied.
+    auto potential_targets = find_enemy_ships(
+      enemy_ships_,
+      local_player_id_,
+      [this, &ship, nearest_attacking_opponent, consider_attack](const Ship& a) {
       // If it would take more than N goes to get there don't bother.
-      return a.is_undocked()
-        || ship.distance_to_edge_min_turns(a) > (consider_attack ? 13 : 5)
-        || (nearest_attacking_opponent != INVALID_ENTITIY_ID && a.owner() != nearest_attacking_opponent);
+      return !(a.is_undocked()
+        || distances_.ship_edge_turns(ship.id(), a.id()) > (consider_attack ? 13 : 5)
+        || (nearest_attacking_opponent != INVALID_ENTITIY_ID && a.owner() != nearest_attacking_opponent));
     }
     );
 
     if ((num_players() == 2) && !potential_targets.empty()) {
-      auto nearest = std::min_element(
+      auto nearest = min_element_by_key(
         potential_targets.cbegin(),
         potential_targets.cend(),
-        [&ship](const Ship& a, const Ship& b) {
-        return ship.distance_to_edge(a) < ship.distance_to_edge(b);
+        [this, &ship](const Ship& a) {
+        return distances_.ship_edge_distance(ship.id(), a.id());
       });
 
-      if (ship.distance_to_edge_min_turns(*nearest) < 5) {
+      if (distances_.ship_edge_turns(ship.id(), nearest->id()) < 5) {
         consider_attack = true;
       }
     } else if (potential_targets.empty()) {
-      potential_targets = find_enemy_ships(enemy_ships_, local_player_id_);
-
-      filter(
-        potential_targets,
+      potential_targets = find_enemy_ships(
+        enemy_ships_,
+        local_player_id_,
         [this, &ship, nearest_attacking_opponent, consider_attack](const Ship& a) {
         if (heading_to_attack_[ship.id()].size() > 2) {
-          return true;
+          return false;
         }
 
         // If it would take more than N goes to get there don't bother.
-        return ship.distance_to_edge_min_turns(a) > (consider_attack ? 13 : 5) ||
-          (nearest_attacking_opponent != INVALID_ENTITIY_ID && a.owner() != nearest_attacking_opponent);
+        return !(distances_.ship_edge_turns(ship.id(), a.id()) > (consider_attack ? 13 : 5) ||
+          (nearest_attacking_opponent != INVALID_ENTITIY_ID && a.owner() != nearest_attacking_opponent));
       }
       );
     }
@@ -994,14 +1103,9 @@ void MapState::run_frame() {
         potential_targets = find_enemy_ships(enemy_ships_, local_player_id_);
       }
 
-      std::sort(
-        std::begin(potential_targets),
-        std::end(potential_targets),
-        [&ship](const Ship& a, const Ship& b) {
-        return ship.distance_to(a) < ship.distance_to(b);
-      });
-
-      for (const auto& target : potential_targets) {
+      // Nearest first, most ships settle on the first target.
+      for (NearestOrder nearest_targets(potential_targets, ship.current_location()); !nearest_targets.empty(); ) {
+        const auto& target = get_ship(nearest_targets.next());
         if (!target.is_undocked() && ship.can_attack(target)) {
           // Already attacking, stay still.
           break;
@@ -1013,8 +1117,7 @@ void MapState::run_frame() {
         double distance_to_nearest_friend = 999999;
         double friend_distance_to_target = 999999;
         EntityId best_friend = -1;
-        for (const auto &partner : player_ships_) {
-          const auto& partner_ship = partner.second;
+        for (const auto &partner_ship : player_ships_) {
           // Can't partner with self.
           if (partner_ship.id() == ship.id()) {
             continue;
@@ -1067,7 +1170,7 @@ void MapState::run_frame() {
 
           const auto velocity =
             navigation::navigate_ship_to_dock(
-              planets_vector,
+              planet_index_,
               all_ships,
               ship,
               target,
@@ -1084,7 +1187,7 @@ void MapState::run_frame() {
 
           const auto friend_velocity =
             navigation::navigate_ship_to_dock(
-              planets_vector,
+              planet_index_,
               all_ships,
               my_ship(best_friend),
               target,
@@ -1102,10 +1205,10 @@ void MapState::run_frame() {
         } else {
 #endif
           // standard move
-          auto navigation_func = target.is_docked() ? navigation::navigate_ship_to_attack : navigation::navigate_ship_to_dock;
+          auto navigation_func = target.is_docked() ? navigation::navigate_ship_to_attack<PlanetIndex, PendingPaths, EntityView<Ship>> : navigation::navigate_ship_to_dock<PlanetIndex, PendingPaths, EntityView<Ship>>;
           const auto velocity =
             navigation_func(
-              planets_vector,
+              planet_index_,
               all_ships,
               ship,
               target,
@@ -1131,11 +1234,13 @@ void MapState::run_frame() {
         if (can_dock(planet, ship)) {
           bool dont_dock_if_under_threat = true;
 
-          if (is_owned_by_opponent(planet, local_player_id_)) {
+          // An owned planet can briefly report no docked ships, there is
+          // nothing to attack then.
+          if (is_owned_by_opponent(planet, local_player_id_) && !planet.is_empty()) {
             const auto &target = get_ship(*planet.docked_ships_.cbegin());
             const auto velocity =
               navigation::navigate_ship_to_attack(
-                planets_vector,
+                planet_index_,
                 all_ships,
                 ship,
                 target,
@@ -1151,19 +1256,22 @@ void MapState::run_frame() {
               raf::Log("No attack move for Ship!");
             }
           } else if (dont_dock_if_under_threat) {
-            auto threats_to_dock = ships_within_range(ship, enemy_ships_, local_player_id_, 3);
+            const auto nearby = area_search_.in_bounds(ship.current_location(), search_radius_for_turns(3));
+            const auto threats_to_dock = nearby.ships(navigation::Side::Enemy) == 0 ?
+              FrameVector<Ship>() :
+              ships_within_range(ship, ship_grid_, local_player_id_, 3);
             if (threats_to_dock.empty()) {
               dock(ship, planet);
             } else {
               // find all nearby friends
               // find all nearby enemies
-              std::sort(std::begin(threats_to_dock), std::end(threats_to_dock), [](const Ship& a, const Ship& b) {
+              // Prefer docked threats.
+              const auto &target = *std::min_element(std::begin(threats_to_dock), std::end(threats_to_dock), [](const Ship& a, const Ship& b) {
                 return a.is_undocked() < b.is_undocked();
               });
-              const auto &target = threats_to_dock.at(0);
               const auto velocity =
                 navigation::navigate_ship_to_attack(
-                  planets_vector,
+                  planet_index_,
                   all_ships,
                   ship,
                   target,
@@ -1187,7 +1295,7 @@ void MapState::run_frame() {
           break;
         }
         auto velocity = raf::navigation::navigate_ship_to_dock(
-          planets_vector,
+          planet_index_,
           all_ships,
           ship,
           planet,
@@ -1212,6 +1320,10 @@ void MapState::run_frame() {
       //heading_to_planet_[p.id()].push_back(e.id());
     }
   }
+
+  if (COORDINATE_ATTACKS) {
+    process_attack(decisions_);
+  }
 }
 
 std::vector<hlt::Move> MapState::post_frame()
@@ -1227,6 +1339,33 @@ void MapState::move(const Ship& ship, const math::Velocity& velocity) {
   // Update ship final location?
 }
 
+void MapState::redirect(const Ship& ship, const math::Vec2d& target) {
+  const auto queued = std::find_if(std::begin(queued_moves_), std::end(queued_moves_), [&ship](const hlt::Move& m) {
+    return m.ship_id == ship.id();
+  });
+  if (queued == std::end(queued_moves_) || queued->type != hlt::MoveType::Thrust) {
+    return;
+  }
+
+  // The ship's own path would block every new one.
+  const math::Velocity previous(queued->move_thrust, queued->move_angle_deg);
+  pending_paths_.erase(ship.id());
+  const auto velocity = navigation::navigate_ship_towards_target(
+    planet_index_,
+    get_all_ships(),
+    ship.current_location(),
+    target,
+    constants::MAX_SPEED,
+    true,
+    constants::MAX_NAVIGATION_CORRECTIONS,
+    math::degrees_to_rads(2),
+    pending_paths_);
+
+  const auto& chosen = velocity.second ? velocity.first : previous;
+  pending_paths_.push_back(Path(ship, chosen));
+  *queued = from_velocity(ship, chosen);
+}
+
 void MapState::dock(const Ship& ship, const Planet& planet)
 {
   heading_to_planet_[planet.id()].insert(ship.id());
@@ -1293,7 +1432,7 @@ void MapState::process_defence(const std::vector<Decision>& all)
         // Find the mid point between the ship being defended and the aggressor
         auto mid_point = (defendee.current_location() + target.current_location()) / 2;
         auto velocity = navigation::navigate_ship_towards_target(
-          get_all_planets(),
+          planet_index_,
           get_all_ships(),
           defender.current_location(),
           mid_point,
@@ -1324,31 +1463,13 @@ void MapState::process_attack(const std::vector<Decision>& all)
 
   // split down by attackee
   std::sort(std::begin(attackers), std::end(attackers), [](const Decision& a, const Decision& b) {
-    return a.target_id < b.target_id;
+    return a.target_id < b.target_id || (a.target_id == b.target_id && a.unit_id < b.unit_id);
   });
 
-  for (
-    auto it = std::begin(attackers), first = it;
-    it < std::end(attackers);
-    it++) {
-    const auto& target = enemy_ships_.at(it->target_id);
-    const auto& ship = player_ships_.at(it->unit_id);
-    auto navigation_func = target.is_docked() ? navigation::navigate_ship_to_attack : navigation::navigate_ship_to_dock;
-    const auto velocity =
-      navigation_func(
-        get_all_planets(),
-        get_all_ships(),
-        ship,
-        target,
-        constants::MAX_SPEED,
-        pending_paths_);
-  }
   // Iterate attack targets
-  // Look for nearest friendly ship within 15 radius
-  // Move to point which is average of A B and Target?
-  // OR move to midpoint of nearest and Target?
-  // Make two friendly ships move within 1 distance of each other..
-
+  // Pair each attacker with its nearest free partner heading for the same
+  // target, and make the two converge on the way there.
+  //
   // E.G if A and B are more than 14 apart then they should head directly towards each other
   // FRIENDLY = {A, B}
   // ENEMY = {T}
@@ -1374,7 +1495,50 @@ void MapState::process_attack(const std::vector<Decision>& all)
   // If Target is 4 turns away, then converge after 2
   //
   // https://gist.github.com/jupdike/bfe5eb23d1c395d8a0a1a4ddd94882ac
+  std::vector<std::pair<EntityId, EntityId>> pairs;
+  math::Vec2dArray a, b, targets;
+  std::vector<bool> paired(attackers.size(), false);
+  for (size_t i = 0; i < attackers.size(); i++) {
+    if (paired[i]) {
+      continue;
+    }
+    const auto& ship = player_ships_.at(attackers[i].unit_id);
+    double nearest = ATTACK_PARTNER_RANGE;
+    size_t partner = attackers.size();
+    for (size_t j = i + 1; j < attackers.size() && attackers[j].target_id == attackers[i].target_id; j++) {
+      if (paired[j]) {
+        continue;
+      }
+      const auto distance = ship.distance_to(player_ships_.at(attackers[j].unit_id));
+      if (distance <= nearest) {
+        nearest = distance;
+        partner = j;
+      }
+    }
+    if (partner == attackers.size()) {
+      continue;
+    }
+    paired[i] = paired[partner] = true;
+    // Already together, both keep heading for the target.
+    if (nearest < math::RENDEZVOUS_DISTANCE) {
+      continue;
+    }
+    pairs.push_back({ attackers[i].unit_id, attackers[partner].unit_id });
+    a.push_back(ship.current_location());
+    b.push_back(player_ships_.at(attackers[partner].unit_id).current_location());
+    targets.push_back(enemy_ships_.at(attackers[i].target_id).current_location());
+  }
 
+  math::Vec2dArray points;
+  math::rendezvous_points(a, b, targets, constants::MAX_SPEED, points);
+  for (size_t i = 0; i < pairs.size(); i++) {
+    const auto point = clear_of_planets(points[i]);
+    for (const auto id : { pairs[i].first, pairs[i].second }) {
+      const auto& ship = player_ships_.at(id);
+      raf::Log("RENDEZVOUS: Moving ship ", ship.id(), " towards ", point);
+      redirect(ship, point);
+    }
+  }
 }
 
 void MapState::process_dock(const std::vector<Decision>& all)
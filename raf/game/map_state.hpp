@@ -1,12 +1,24 @@
 #ifndef RAF_MAP_STATE_H_
 #define RAF_MAP_STATE_H_
 
+#include "approach_queue.hpp"
+#include "area_search.hpp"
 #include "decision.hpp"
+#include "distance_cache.hpp"
 #include "entity.hpp"
+#include "entity_store.hpp"
+#include "frame_arena.hpp"
+#include "nearest.hpp"
 #include "path.hpp"
+#include "pending_paths.hpp"
 #include "planet.hpp"
+#include "planet_distance_field.hpp"
+#include "planet_index.hpp"
+#include "planet_travel.hpp"
 #include "player.hpp"
 #include "ship.hpp"
+#include "hierarchical_grid.hpp"
+#include "map_symmetry.hpp"
 #include "../types.hpp"
 
 #include "navigation.hpp"
@@ -15,6 +27,7 @@
 #include <algorithm>
 #include <functional>
 #include <map>
+#include <set>
 #include <vector>
 
 namespace raf {
@@ -89,13 +102,26 @@ private:
   std::set<game::PlayerId> valid_player_ids_;
 };
 
+// Docked ships watch for enemies within four turns of them, padded for the
+// drift allowed in a pair's predictions before either ship is predicted again.
+constexpr double DOCKED_THREAT_RANGE = 3 * constants::MAX_SPEED + 1.0
+  + 3 * navigation::DEFAULT_APPROACH_HORIZON * navigation::DEFAULT_APPROACH_VELOCITY_THRESHOLD;
+
 class MapState {
 public:
   MapState(raf::math::Vec2i dimensions, game::EntityId local_player_id, int initial_players)
     : current_round_(0),
     local_player_id_(local_player_id),
     dimensions_(dimensions),
-    initial_players_(initial_players) {
+    initial_players_(initial_players),
+    planet_index_(dimensions),
+    planet_travel_(dimensions),
+    symmetry_(dimensions),
+    planet_field_(dimensions),
+    ship_grid_(dimensions),
+    approaches_(navigation::DEFAULT_APPROACH_HORIZON, navigation::DEFAULT_APPROACH_VELOCITY_THRESHOLD, DOCKED_THREAT_RANGE),
+    area_search_(dimensions),
+    distances_(dimensions) {
   }
 
   void BeginRound(int round_number) {
@@ -105,12 +131,6 @@ public:
     valid_players_.clear();
   }
 
-#if 0
-  game::Planet nearest_planet_to(const game::Entity& entity) {
-    return players_.at(0).nearest_planet_to(entity);
-  }
-#endif
-
   // Update
   // Take a new snapshot of data and apply it to existing persistant data
   // If the new entity does not exist then create it, else update it.
@@ -120,6 +140,8 @@ public:
   void mark_valid(const Ship& ship);
   bool is_valid(const Planet& planet) const;
   bool is_valid(const Ship& ship) const;
+  // Build static map data. Call once after the initial map has been applied.
+  void pre_game();
   void pre_frame();
   void run_frame();
   std::vector<hlt::Move> post_frame();
@@ -128,9 +150,20 @@ public:
     return valid_players_.size();
   }
 
+  // Symmetry of the initial map. Valid after pre_game().
+  const MapSymmetry& symmetry() const {
+    return symmetry_;
+  }
+
 private:
   bool can_dock_more(game::EntityId planet_id) const;
   void prune_dead_entities();
+  void build_area_search();
+  void rank_opponents_by_home();
+  // Nearest opponent by home planet still in the game, or INVALID_ENTITIY_ID.
+  PlayerId nearest_opponent_by_home() const;
+  // point, moved out of any planet it lies inside or against.
+  math::Vec2d clear_of_planets(const math::Vec2d& point) const;
 
   bool has_already_moved(const Ship& ship) const {
     return moved_ships_.count(ship.id());
@@ -145,6 +178,9 @@ private:
   }
 
   void move(const Ship& ship, const math::Velocity& velocity);
+  // Replace ship's queued thrust with one towards target, keeping the old
+  // one if there is no way through.
+  void redirect(const Ship& ship, const math::Vec2d& target);
   void dock(const Ship& ship, const Planet& planet);
 
   void attack(const Ship& attacker, const Ship& target);
@@ -165,7 +201,7 @@ private:
 
   const Ship& get_ship(EntityId id) const {
     // Check player ships first
-    bool is_player_ship = player_ships_.find(id) != std::end(player_ships_);
+    bool is_player_ship = player_ships_.contains(id);
     if (is_player_ship) {
       return my_ship(id);
     }
@@ -177,19 +213,13 @@ private:
   void process_attack(const std::vector<Decision>& all);
   void process_dock(const std::vector<Decision>& all);
 
-  std::vector<Ship> get_all_ships() const {
-    const auto local_ship_vector = map_to_vector(player_ships_);
-    const auto enemy_vector = map_to_vector(enemy_ships_);
-    std::vector<Ship> result;
-    result.reserve(local_ship_vector.size() + enemy_vector.size());
-    result.insert(std::end(result), std::begin(local_ship_vector), std::end(local_ship_vector));
-    result.insert(std::end(result), std::begin(enemy_vector), std::end(enemy_vector));
-
-    return result;
+  // Views, valid until ships or planets are next added or removed.
+  EntityView<Ship> get_all_ships() const {
+    return EntityView<Ship>(player_ships_, enemy_ships_);
   }
 
-  std::vector<Planet> get_all_planets() const {
-    return map_to_vector(planets_);
+  EntityView<Planet> get_all_planets() const {
+    return EntityView<Planet>(planets_);
   }
 
   int current_round_;
@@ -198,9 +228,31 @@ private:
   game::EntityId local_player_id_;
 
   // These need combining...
-  std::map<game::EntityId, game::Ship> enemy_ships_;
-  std::map<game::EntityId, game::Ship> player_ships_;
-  std::map<game::EntityId, game::Planet> planets_;
+  EntityStore<game::Ship> enemy_ships_;
+  EntityStore<game::Ship> player_ships_;
+  EntityStore<game::Planet> planets_;
+
+  // Static planet geometry, built in pre_game() and refreshed each frame.
+  PlanetIndex planet_index_;
+  PlanetTravelTable planet_travel_;
+  MapSymmetry symmetry_;
+  PlanetDistanceField planet_field_;
+  // Opponents by travel distance from our home planet to theirs, nearest
+  // first. Built in pre_game().
+  std::vector<game::PlayerId> opponents_by_home_;
+
+  // Multi-level bucketed lookup of all live ships, kept current by update()
+  // and prune_dead_entities().
+  HierarchicalGrid<game::Ship> ship_grid_;
+
+  // Predicted approaches between live ships, updated in pre_frame().
+  navigation::ApproachQueue approaches_;
+
+  // Ship totals by area, rebuilt in pre_frame().
+  navigation::AreaSearch area_search_;
+
+  // Our ships to enemy ships and planets, rebuilt in pre_frame().
+  DistanceCache distances_;
 
   std::set<game::EntityId> valid_planets_;
   std::set<game::EntityId> valid_ships_;
@@ -212,7 +264,7 @@ private:
 
   // Paths pending by game entities.
   // Should be checked against before moving a ship.
-  std::vector<Path> pending_paths_;
+  PendingPaths pending_paths_;
   // 
   std::vector<hlt::Move> queued_moves_;
 
@@ -225,17 +277,41 @@ private:
 
 
 std::vector<game::Planet> dockable_planets(
-  const std::map<game::EntityId, game::Planet>& planets_,
+  const EntityStore<game::Planet>& planets_,
   game::PlayerId player_id);
 
 std::vector<game::Planet> opponent_planets(
-  const std::map<game::EntityId, game::Planet>& planets_,
+  const EntityStore<game::Planet>& planets_,
   game::PlayerId player_id);
 
-std::vector<Ship> find_enemy_ships(
-  const std::map<EntityId, Ship>& ships,
+FrameVector<Ship> find_enemy_ships(
+  const EntityStore<Ship>& ships,
   hlt::PlayerId local_player_id);
 
+// As above, but only copies the ships keep(ship) is true for.
+template<typename Pred>
+FrameVector<Ship> find_enemy_ships(
+  const EntityStore<Ship>& ships,
+  hlt::PlayerId local_player_id,
+  const Pred& keep)
+{
+  FrameVector<Ship> enemy_ships;
+  for (const auto &ship : ships) {
+    if (ship.owner() == local_player_id) {
+      continue;
+    }
+
+    if (!ship.is_alive()) {
+      continue;
+    }
+
+    if (keep(ship)) {
+      enemy_ships.push_back(ship);
+    }
+  }
+  return enemy_ships;
+}
+
 }
 }
 
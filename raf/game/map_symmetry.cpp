@@ -0,0 +1,168 @@
+#include "map_symmetry.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace raf {
+namespace game {
+
+MapSymmetry::MapSymmetry(const math::Vec2i& dimensions)
+  : dimensions_(dimensions),
+  flips_({ Flip::None }) {
+}
+
+void MapSymmetry::detect_sites(const std::vector<Site>& planets, const std::vector<const Ship*>& ships) {
+  // Spawns are the center of each player's ships.
+  std::map<PlayerId, std::pair<math::Vec2d, int>> sums;
+  for (const auto* ship : ships) {
+    auto& sum = sums[ship->owner()];
+    sum.first += ship->current_location();
+    sum.second++;
+  }
+  spawns_.clear();
+  for (const auto& e : sums) {
+    const auto location = e.second.first / e.second.second;
+    EntityId home = INVALID_ENTITIY_ID;
+    double best = std::numeric_limits<double>::infinity();
+    for (const auto& planet : planets) {
+      const auto distance = (planet.location - location).length() - planet.radius;
+      if (distance < best) {
+        best = distance;
+        home = planet.id;
+      }
+    }
+    spawns_.push_back({ e.first, location, home });
+  }
+
+  flips_.assign(1, Flip::None);
+  for (auto& images : images_) {
+    images.clear();
+  }
+  EntityId max_id = -1;
+  for (const auto& planet : planets) {
+    max_id = std::max(max_id, planet.id);
+  }
+  images_[static_cast<int>(Flip::None)].resize(max_id + 1, INVALID_ENTITIY_ID);
+  for (const auto& planet : planets) {
+    images_[static_cast<int>(Flip::None)][planet.id] = planet.id;
+  }
+
+  for (const auto flip : { Flip::X, Flip::Y, Flip::XY }) {
+    auto images = match(flip, planets);
+    if (!images.empty()) {
+      images_[static_cast<int>(flip)] = std::move(images);
+      flips_.push_back(flip);
+    }
+  }
+}
+
+std::vector<EntityId> MapSymmetry::match(Flip flip, const std::vector<Site>& planets) const {
+  // An empty map has nothing to mirror.
+  if (planets.empty()) {
+    return std::vector<EntityId>();
+  }
+  for (const auto& spawn : spawns_) {
+    if (mirror_player(spawn.player, flip) == INVALID_ENTITIY_ID) {
+      return std::vector<EntityId>();
+    }
+  }
+
+  std::vector<EntityId> images(images_[static_cast<int>(Flip::None)].size(), INVALID_ENTITIY_ID);
+  for (const auto& planet : planets) {
+    const auto image = apply(flip, planet.location);
+    const auto found = std::find_if(std::begin(planets), std::end(planets), [&](const Site& other) {
+      return (other.location - image).length_squared() <= SYMMETRY_TOLERANCE * SYMMETRY_TOLERANCE
+        && std::abs(other.radius - planet.radius) <= SYMMETRY_TOLERANCE;
+    });
+    if (found == std::end(planets)) {
+      return std::vector<EntityId>();
+    }
+    images[planet.id] = found->id;
+  }
+  return images;
+}
+
+bool MapSymmetry::has(Flip flip) const {
+  return std::find(std::begin(flips_), std::end(flips_), flip) != std::end(flips_);
+}
+
+math::Vec2d MapSymmetry::apply(Flip flip, const math::Vec2d& location) const {
+  const auto bits = static_cast<int>(flip);
+  return {
+    (bits & static_cast<int>(Flip::X)) ? dimensions_.x() - location.x() : location.x(),
+    (bits & static_cast<int>(Flip::Y)) ? dimensions_.y() - location.y() : location.y()
+  };
+}
+
+Flip MapSymmetry::to_fundamental(const math::Vec2d& location) const {
+  auto flip = Flip::None;
+  if (location.x() > dimensions_.x() / 2.0) {
+    if (has(Flip::X)) {
+      flip = Flip::X;
+    } else if (has(Flip::XY)) {
+      flip = Flip::XY;
+    }
+  }
+  // Only a flip of y alone keeps the x half just chosen.
+  if (apply(flip, location).y() > dimensions_.y() / 2.0 && has(flip ^ Flip::Y)) {
+    flip = flip ^ Flip::Y;
+  }
+  return flip;
+}
+
+EntityId MapSymmetry::mirror_planet(EntityId planet, Flip flip) const {
+  const auto& images = images_[static_cast<int>(flip)];
+  if (planet < 0 || planet >= static_cast<EntityId>(images.size())) {
+    return INVALID_ENTITIY_ID;
+  }
+  return images[planet];
+}
+
+PlayerId MapSymmetry::mirror_player(PlayerId player, Flip flip) const {
+  const auto* spawn = find_spawn(player);
+  if (spawn == nullptr) {
+    return INVALID_ENTITIY_ID;
+  }
+  const auto image = apply(flip, spawn->location);
+  for (const auto& other : spawns_) {
+    if ((other.location - image).length_squared() <= SYMMETRY_TOLERANCE * SYMMETRY_TOLERANCE) {
+      return other.player;
+    }
+  }
+  return INVALID_ENTITIY_ID;
+}
+
+possibly<Flip> MapSymmetry::flip_between(PlayerId from, PlayerId to) const {
+  for (const auto flip : flips_) {
+    if (mirror_player(from, flip) == to) {
+      return { flip, true };
+    }
+  }
+  return { Flip::None, false };
+}
+
+EntityId MapSymmetry::counterpart(EntityId planet, PlayerId from, PlayerId to) const {
+  const auto flip = flip_between(from, to);
+  if (!flip.second) {
+    return INVALID_ENTITIY_ID;
+  }
+  return mirror_planet(planet, flip.first);
+}
+
+EntityId MapSymmetry::home_planet(PlayerId player) const {
+  const auto* spawn = find_spawn(player);
+  return spawn == nullptr ? INVALID_ENTITIY_ID : spawn->home_planet;
+}
+
+const MapSymmetry::Spawn* MapSymmetry::find_spawn(PlayerId player) const {
+  for (const auto& spawn : spawns_) {
+    if (spawn.player == player) {
+      return &spawn;
+    }
+  }
+  return nullptr;
+}
+
+}
+}
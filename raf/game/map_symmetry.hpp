@@ -0,0 +1,151 @@
+#ifndef RAF_GAME_MAP_SYMMETRY_H_
+#define RAF_GAME_MAP_SYMMETRY_H_
+
+#include "entity.hpp"
+#include "planet.hpp"
+#include "player.hpp"
+#include "ship.hpp"
+#include "../math/math.hpp"
+#include "../types.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// How far a mirrored planet or spawn may land from its counterpart.
+constexpr double SYMMETRY_TOLERANCE = 0.01;
+
+// Reflections of the map about its center, as the axes they flip. Flips are
+// their own inverse, and composing two is an xor, so X then Y is XY, a half
+// turn.
+enum class Flip {
+  None = 0,
+  X = 1,
+  Y = 2,
+  XY = 3,
+};
+
+inline Flip operator^(Flip a, Flip b) {
+  return static_cast<Flip>(static_cast<int>(a) ^ static_cast<int>(b));
+}
+
+// The symmetry of the initial map.
+//
+// Maps are generated with 2 or 4 fold symmetry, so anything computed from
+// static geometry only has to be computed for the fundamental region, the
+// part every other part is a mirror image of. The same flips pair up player
+// spawns, which gives each opponent's home planet and likely opening targets
+// as a lookup rather than a search.
+//
+// Detection compares planets and spawns to their mirror images, so a map
+// without symmetry reports just Flip::None and every lookup falls back to
+// the identity.
+class MapSymmetry {
+public:
+  explicit MapSymmetry(const math::Vec2i& dimensions);
+
+  // Find the symmetry of the initial planets and spawned ships. Call once,
+  // before the first move, with every planet and every ship.
+  template<typename Planets, typename Ships>
+  void detect(const Planets& planets, const Ships& ships) {
+    std::vector<const Ship*> spawned;
+    for (const auto& e : ships) {
+      spawned.push_back(&ship_of(e));
+    }
+    detect_sites(collect_planets(planets), spawned);
+  }
+
+  // detect() for ships split across two containers.
+  template<typename Planets, typename Ships>
+  void detect(const Planets& planets, const Ships& ships, const Ships& more_ships) {
+    std::vector<const Ship*> spawned;
+    for (const auto& e : ships) {
+      spawned.push_back(&ship_of(e));
+    }
+    for (const auto& e : more_ships) {
+      spawned.push_back(&ship_of(e));
+    }
+    detect_sites(collect_planets(planets), spawned);
+  }
+
+  const math::Vec2i& dimensions() const { return dimensions_; }
+
+  // Flips that map the map onto itself, Flip::None first.
+  const std::vector<Flip>& flips() const { return flips_; }
+  bool is_symmetric() const { return flips_.size() > 1; }
+  bool has(Flip flip) const;
+
+  math::Vec2d apply(Flip flip, const math::Vec2d& location) const;
+
+  // The flip taking location into the fundamental region, and back out
+  // again. The region is the lower x half for X or XY symmetry, then the
+  // lower y half of that for Y symmetry.
+  Flip to_fundamental(const math::Vec2d& location) const;
+
+  // The planet flip takes planet to, or INVALID_ENTITIY_ID if flip is not a
+  // symmetry of the map.
+  EntityId mirror_planet(EntityId planet, Flip flip) const;
+
+  // The player whose spawn flip takes player's to, or INVALID_ENTITIY_ID.
+  PlayerId mirror_player(PlayerId player, Flip flip) const;
+
+  // The flip taking from's spawn onto to's, if there is one.
+  possibly<Flip> flip_between(PlayerId from, PlayerId to) const;
+
+  // to's counterpart of a planet on from's side of the map, e.g. the planet
+  // an opponent opens on if they play as we do. INVALID_ENTITIY_ID if their
+  // spawns are not mirror images.
+  EntityId counterpart(EntityId planet, PlayerId from, PlayerId to) const;
+
+  // Planet nearest a player's spawn, INVALID_ENTITIY_ID for an unknown
+  // player or a map with no planets.
+  EntityId home_planet(PlayerId player) const;
+
+private:
+  struct Site {
+    EntityId id;
+    math::Vec2d location;
+    double radius;
+  };
+
+  struct Spawn {
+    PlayerId player;
+    math::Vec2d location;
+    EntityId home_planet;
+  };
+
+  static const Planet& planet_of(const Planet& planet) { return planet; }
+  static const Planet& planet_of(const std::pair<const EntityId, Planet>& e) { return e.second; }
+  static const Ship& ship_of(const Ship& ship) { return ship; }
+  static const Ship& ship_of(const std::pair<const EntityId, Ship>& e) { return e.second; }
+
+  template<typename Planets>
+  static std::vector<Site> collect_planets(const Planets& planets) {
+    std::vector<Site> sites;
+    for (const auto& e : planets) {
+      const auto& planet = planet_of(e);
+      sites.push_back({ planet.id(), planet.current_location(), planet.radius() });
+    }
+    return sites;
+  }
+
+  void detect_sites(const std::vector<Site>& planets, const std::vector<const Ship*>& ships);
+  // Planet images under flip, indexed by planet id, or empty if flip does
+  // not map every planet and spawn onto another.
+  std::vector<EntityId> match(Flip flip, const std::vector<Site>& planets) const;
+  const Spawn* find_spawn(PlayerId player) const;
+
+  math::Vec2i dimensions_;
+  std::vector<Flip> flips_;
+  // Planet images indexed by flip, then planet id.
+  std::vector<EntityId> images_[4];
+  std::vector<Spawn> spawns_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_MAP_SYMMETRY_H_
@@ -0,0 +1,148 @@
+#include "map_symmetry.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+using raf::game::EntityId;
+using raf::game::Flip;
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::MapSymmetry;
+using raf::game::Planet;
+using raf::game::Ship;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+
+static const Vec2i DIMENSIONS(240, 160);
+
+static Vec2d flipped(Flip flip, const Vec2d& location) {
+  return {
+    (static_cast<int>(flip) & 1) ? DIMENSIONS.x() - location.x() : location.x(),
+    (static_cast<int>(flip) & 2) ? DIMENSIONS.y() - location.y() : location.y()
+  };
+}
+
+// Planets placed in one half or quadrant then mirrored by each flip, ids
+// interleaved as the game does not group them.
+static std::map<EntityId, Planet> mirrored_planets(const std::vector<Flip>& flips, std::mt19937& rng) {
+  std::uniform_real_distribution<double> x(10, DIMENSIONS.x() / 2 - 10);
+  std::uniform_real_distribution<double> y(10, DIMENSIONS.y() / 2 - 10);
+  std::uniform_real_distribution<double> radius(3, 8);
+  std::map<EntityId, Planet> planets;
+  EntityId id = 0;
+  for (int i = 0; i < 6; i++) {
+    const Vec2d location(x(rng), y(rng));
+    const double r = radius(rng);
+    for (const auto flip : flips) {
+      planets.emplace(id, Planet(id, INVALID_ENTITIY_ID, flipped(flip, location), r, 1000, 3));
+      id++;
+    }
+  }
+  return planets;
+}
+
+// Three ships per player, stacked vertically about each spawn.
+static std::map<EntityId, Ship> spawned_ships(const std::vector<Vec2d>& spawns) {
+  std::map<EntityId, Ship> ships;
+  EntityId id = 0;
+  for (int player = 0; player < static_cast<int>(spawns.size()); player++) {
+    for (int i = -1; i <= 1; i++) {
+      ships.emplace(id, Ship(id, player, spawns[player] + Vec2d(0, 2.0 * i), 0.5, 255));
+      id++;
+    }
+  }
+  return ships;
+}
+
+TEST(raf_map_symmetry, asymmetric)
+{
+  std::mt19937 rng(1);
+  auto planets = mirrored_planets({ Flip::None, Flip::X }, rng);
+  planets.at(3) = Planet(3, INVALID_ENTITIY_ID, { 200, 20 }, 4, 1000, 3);
+  MapSymmetry symmetry(DIMENSIONS);
+  symmetry.detect(planets, spawned_ships({ { 40, 80 }, { 200, 80 } }));
+
+  ASSERT_FALSE(symmetry.is_symmetric());
+  ASSERT_EQ(Flip::None, symmetry.to_fundamental({ 230, 150 }));
+  ASSERT_EQ(5, symmetry.mirror_planet(5, Flip::None));
+  ASSERT_EQ(INVALID_ENTITIY_ID, symmetry.mirror_planet(5, Flip::X));
+  ASSERT_EQ(INVALID_ENTITIY_ID, symmetry.counterpart(5, 0, 1));
+}
+
+TEST(raf_map_symmetry, two_players_half_turn)
+{
+  std::mt19937 rng(2);
+  const auto planets = mirrored_planets({ Flip::None, Flip::XY }, rng);
+  MapSymmetry symmetry(DIMENSIONS);
+  symmetry.detect(planets, spawned_ships({ { 40, 50 }, { 200, 110 } }));
+
+  ASSERT_EQ(std::vector<Flip>({ Flip::None, Flip::XY }), symmetry.flips());
+  ASSERT_EQ(1, symmetry.mirror_player(0, Flip::XY));
+  ASSERT_EQ(Flip::XY, symmetry.flip_between(0, 1).first);
+  for (const auto& e : planets) {
+    const auto image = symmetry.mirror_planet(e.first, Flip::XY);
+    ASSERT_EQ(e.first ^ 1, image);
+    ASSERT_EQ(image, symmetry.counterpart(e.first, 0, 1));
+  }
+  ASSERT_EQ(symmetry.home_planet(1), symmetry.counterpart(symmetry.home_planet(0), 0, 1));
+
+  // The region is the left half, the right half turns into it.
+  ASSERT_EQ(Flip::None, symmetry.to_fundamental({ 100, 150 }));
+  ASSERT_EQ(Flip::XY, symmetry.to_fundamental({ 140, 10 }));
+}
+
+TEST(raf_map_symmetry, four_players_quadrants)
+{
+  std::mt19937 rng(3);
+  const std::vector<Flip> flips = { Flip::None, Flip::X, Flip::Y, Flip::XY };
+  const auto planets = mirrored_planets(flips, rng);
+  MapSymmetry symmetry(DIMENSIONS);
+  symmetry.detect(planets, spawned_ships({ { 30, 30 }, { 210, 30 }, { 30, 130 }, { 210, 130 } }));
+
+  ASSERT_EQ(flips, symmetry.flips());
+  ASSERT_EQ(1, symmetry.mirror_player(0, Flip::X));
+  ASSERT_EQ(2, symmetry.mirror_player(0, Flip::Y));
+  ASSERT_EQ(3, symmetry.mirror_player(0, Flip::XY));
+  ASSERT_EQ(Flip::XY, symmetry.flip_between(1, 2).first);
+  for (int player = 1; player < 4; player++) {
+    ASSERT_EQ(symmetry.home_planet(player), symmetry.counterpart(symmetry.home_planet(0), 0, player));
+  }
+
+  // Every point maps into the bottom left quadrant.
+  std::uniform_real_distribution<double> x(0, DIMENSIONS.x());
+  std::uniform_real_distribution<double> y(0, DIMENSIONS.y());
+  for (int i = 0; i < 1000; i++) {
+    const Vec2d location(x(rng), y(rng));
+    const auto image = symmetry.apply(symmetry.to_fundamental(location), location);
+    ASSERT_LE(image.x(), DIMENSIONS.x() / 2.0) << location;
+    ASSERT_LE(image.y(), DIMENSIONS.y() / 2.0) << location;
+  }
+}
+
+// Planets symmetric about x, but the spawns only about the center.
+TEST(raf_map_symmetry, spawns_pick_the_flip)
+{
+  std::mt19937 rng(4);
+  const auto planets = mirrored_planets({ Flip::None, Flip::X, Flip::Y, Flip::XY }, rng);
+  MapSymmetry symmetry(DIMENSIONS);
+  symmetry.detect(planets, spawned_ships({ { 40, 50 }, { 200, 110 } }));
+
+  ASSERT_EQ(std::vector<Flip>({ Flip::None, Flip::XY }), symmetry.flips());
+}
+
+TEST(raf_map_symmetry, tolerates_rounding)
+{
+  std::mt19937 rng(5);
+  auto planets = mirrored_planets({ Flip::None, Flip::X }, rng);
+  const auto& moved = planets.at(1);
+  planets.at(1) = Planet(1, INVALID_ENTITIY_ID, moved.current_location() + Vec2d(0.004, -0.004), moved.radius(), 1000, 3);
+  MapSymmetry symmetry(DIMENSIONS);
+  symmetry.detect(planets, spawned_ships({ { 40, 80 }, { 200, 80 } }));
+
+  ASSERT_TRUE(symmetry.has(Flip::X));
+  ASSERT_EQ(1, symmetry.mirror_planet(0, Flip::X));
+}
@@ -0,0 +1,122 @@
+#include "move_lattice.hpp"
+#include "pending_paths.hpp"
+#include "../math/vec2x4.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace raf {
+namespace navigation {
+
+// Distance from point to the segment start->end.
+static double distance_to_segment(const math::Vec2d& point, const math::Vec2d& start, const math::Vec2d& end) {
+  const auto segment = end - start;
+  const double length_squared = segment.length_squared();
+  if (length_squared == 0) {
+    return (point - start).length();
+  }
+  const double t = std::max(0.0, std::min(1.0, dot_product(point - start, segment) / length_squared));
+  return (point - (start + segment * t)).length();
+}
+
+// Displacement of every moving move, angle major: index angle * MAX_SPEED + thrust - 1.
+static const math::Vec2dArray& lattice_displacements() {
+  static const math::Vec2dArray displacements = [] {
+    math::Vec2dArray moves;
+    moves.reserve(MoveLattice::DEGREES * constants::MAX_SPEED);
+    for (int angle = 0; angle < MoveLattice::DEGREES; angle++) {
+      for (int thrust = 1; thrust <= constants::MAX_SPEED; thrust++) {
+        moves.push_back(math::MoveTable::instance().displacement(thrust, angle));
+      }
+    }
+    return moves;
+  }();
+  return displacements;
+}
+
+MoveLattice::MoveLattice(const math::Vec2d& start, int max_thrust)
+  : start_(start),
+  max_thrust_(std::max(0, std::min(max_thrust, constants::MAX_SPEED))) {
+  max_static_thrust_.fill(0);
+  path_blocked_.fill(0);
+}
+
+void MoveLattice::add_obstacle(const math::Vec2d& center, double radius) {
+  if (center == start_) {
+    return;
+  }
+  if ((center - start_).length() - radius - constants::FORECAST_FUDGE_FACTOR > max_thrust_) {
+    return;
+  }
+  obstacles_.push_back(center, radius);
+}
+
+void MoveLattice::add_path(const game::Path& path) {
+  // Both ships stay within their own move of where they started.
+  const double reach = max_thrust_ + path.radius * game::PATH_CLEARANCE_FACTOR;
+  if (distance_to_segment(start_, path.start_pos, path.end_pos) >= reach) {
+    return;
+  }
+  paths_.push_back(path);
+}
+
+void MoveLattice::evaluate() {
+  const auto& table = math::MoveTable::instance();
+  const double fudge = constants::FORECAST_FUDGE_FACTOR;
+  for (int angle = 0; angle < DEGREES; angle++) {
+    int allowed = max_thrust_;
+    if (obstacles_.size() > 0 && max_thrust_ > 0
+      && collision::first_segment_circle_hit(start_, start_ + table.displacement(max_thrust_, angle), obstacles_, fudge) >= 0) {
+      // Something is in the way, binary search for the last clear thrust.
+      int clear = 0;
+      int blocked = max_thrust_;
+      while (blocked - clear > 1) {
+        const int thrust = (clear + blocked) / 2;
+        if (collision::first_segment_circle_hit(start_, start_ + table.displacement(thrust, angle), obstacles_, fudge) < 0) {
+          clear = thrust;
+        } else {
+          blocked = thrust;
+        }
+      }
+      allowed = clear;
+    }
+    max_static_thrust_[angle] = allowed;
+    path_blocked_[angle] = 0;
+  }
+
+  // Each path against every move at once, using the same closest-approach
+  // test as navigation::collides_with_path.
+  const auto& moves = lattice_displacements();
+  std::vector<double> dist_squared;
+  for (const auto& path : paths_) {
+    math::min_dist_squared(path.start_pos, path.end_pos - path.start_pos, start_, moves, dist_squared);
+    const double clearance = path.radius * game::PATH_CLEARANCE_FACTOR;
+    for (int angle = 0; angle < DEGREES; angle++) {
+      for (int thrust = 1; thrust <= max_static_thrust_[angle]; thrust++) {
+        if (std::sqrt(dist_squared[angle * constants::MAX_SPEED + thrust - 1]) < clearance) {
+          path_blocked_[angle] |= static_cast<unsigned char>(1 << thrust);
+        }
+      }
+    }
+  }
+}
+
+bool MoveLattice::is_legal(int thrust, int angle_in_degrees) const {
+  if (thrust == 0) {
+    return true;
+  }
+  return thrust <= max_static_thrust_[angle_in_degrees] && (path_blocked_[angle_in_degrees] & (1 << thrust)) == 0;
+}
+
+int MoveLattice::legal_moves() const {
+  int legal = 1;
+  for (int angle = 0; angle < DEGREES; angle++) {
+    for (int thrust = 1; thrust <= max_static_thrust_[angle]; thrust++) {
+      legal += is_legal(thrust, angle) ? 1 : 0;
+    }
+  }
+  return legal;
+}
+
+}
+}
@@ -0,0 +1,113 @@
+#ifndef RAF_GAME_MOVE_LATTICE_H_
+#define RAF_GAME_MOVE_LATTICE_H_
+
+#include "collision.hpp"
+#include "path.hpp"
+#include "../math/math.hpp"
+
+#include <array>
+#include <vector>
+
+namespace raf {
+namespace navigation {
+
+// Every move a ship can make this turn, checked in one pass.
+//
+// Integer thrusts and angles give 7 * 360 moves plus standing still. Static
+// obstacles (planets, ships that are not moving) are tested per heading with
+// the batched segment kernel: a heading is blocked from the first thrust
+// whose segment hits something, since the ship passes through every shorter
+// move on the way. Committed paths are not monotonic in thrust, so every
+// move is tested against each path within reach as a math::Vec2dArray batch.
+//
+// The work is bounded by the lattice size and the number of nearby
+// obstacles, whatever the layout, unlike the greedy correction sweep.
+class MoveLattice {
+public:
+  static constexpr int DEGREES = math::MoveTable::DEGREES;
+
+  // max_thrust is clamped to [0, MAX_SPEED].
+  MoveLattice(const math::Vec2d& start, int max_thrust = constants::MAX_SPEED);
+
+  // A stationary obstacle. The fudge factor is added as objects_between does.
+  // Obstacles out of reach, or centred on start, are ignored.
+  void add_obstacle(const math::Vec2d& center, double radius);
+
+  // A move committed by another ship this frame. Paths out of reach are ignored.
+  void add_path(const game::Path& path);
+
+  // Work out which moves are legal. Call once after the last add.
+  void evaluate();
+
+  bool is_legal(int thrust, int angle_in_degrees) const;
+
+  // Fastest legal thrust along a heading, 0 if it is blocked outright.
+  int max_static_thrust(int angle_in_degrees) const { return max_static_thrust_[angle_in_degrees]; }
+
+  // Legal move with the lowest cost(const math::Velocity& move, const Vec2d& end).
+  // Standing still is always legal and is scored first, so ties keep the
+  // ship where it is. Among moves, ties go to the lowest angle then thrust.
+  template<typename Cost>
+  math::Velocity best(Cost cost) const {
+    math::Velocity best_move(0, 0);
+    double best_cost = cost(best_move, start_);
+    const auto& table = math::MoveTable::instance();
+    for (int angle = 0; angle < DEGREES; angle++) {
+      for (int thrust = 1; thrust <= max_static_thrust_[angle]; thrust++) {
+        if (!is_legal(thrust, angle)) {
+          continue;
+        }
+        const math::Velocity move(thrust, angle);
+        const double move_cost = cost(move, start_ + table.displacement(thrust, angle));
+        if (move_cost < best_cost) {
+          best_cost = move_cost;
+          best_move = move;
+        }
+      }
+    }
+    return best_move;
+  }
+
+  // Number of legal moves, including standing still.
+  int legal_moves() const;
+
+private:
+  math::Vec2d start_;
+  int max_thrust_;
+  collision::CircleSet obstacles_;
+  std::vector<game::Path> paths_;
+  std::array<int, DEGREES> max_static_thrust_;
+  // Bit t set if thrust t along that heading clips a committed path.
+  std::array<unsigned char, DEGREES> path_blocked_;
+};
+
+// Squared distance from the end of the move to a target.
+struct DistanceToTarget {
+  math::Vec2d target;
+
+  double operator()(const math::Velocity&, const math::Vec2d& end) const {
+    return (end - target).length_squared();
+  }
+};
+
+// Number of threats within range of the end of the move, scaled by weight.
+struct ThreatExposure {
+  std::vector<math::Vec2d> threats;
+  double range;
+  double weight;
+
+  double operator()(const math::Velocity&, const math::Vec2d& end) const {
+    int count = 0;
+    for (const auto& threat : threats) {
+      if ((threat - end).length_squared() <= range * range) {
+        count++;
+      }
+    }
+    return count * weight;
+  }
+};
+
+}
+}
+
+#endif // !RAF_GAME_MOVE_LATTICE_H_
@@ -0,0 +1,161 @@
+#include "move_lattice.hpp"
+#include "collision.hpp"
+#include "navigation.hpp"
+#include "pending_paths.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::Path;
+using raf::game::Planet;
+using raf::game::Ship;
+using raf::math::MoveTable;
+using raf::math::Vec2d;
+using raf::math::Velocity;
+using raf::navigation::DistanceToTarget;
+using raf::navigation::MoveLattice;
+using raf::navigation::ThreatExposure;
+
+struct Circle {
+  Vec2d center;
+  double radius;
+};
+
+TEST(raf_move_lattice, open_space)
+{
+  MoveLattice lattice({ 50, 50 });
+  lattice.evaluate();
+  ASSERT_EQ(7 * 360 + 1, lattice.legal_moves());
+
+  const auto move = lattice.best(DistanceToTarget{ { 60, 50 } });
+  ASSERT_EQ(7, move.thrust());
+  ASSERT_EQ(0, move.angle_in_degrees());
+
+  const auto close = lattice.best(DistanceToTarget{ { 50, 47 } });
+  ASSERT_EQ(3, close.thrust());
+  ASSERT_EQ(270, close.angle_in_degrees());
+
+  const auto stay = lattice.best(DistanceToTarget{ { 50, 50 } });
+  ASSERT_EQ(0, stay.thrust());
+}
+
+TEST(raf_move_lattice, max_thrust_limits_moves)
+{
+  MoveLattice lattice({ 50, 50 }, 3);
+  lattice.evaluate();
+  ASSERT_EQ(3 * 360 + 1, lattice.legal_moves());
+  ASSERT_EQ(3, lattice.best(DistanceToTarget{ { 80, 50 } }).thrust());
+}
+
+TEST(raf_move_lattice, obstacle_blocks_heading)
+{
+  MoveLattice lattice({ 0, 0 });
+  lattice.add_obstacle({ 5, 0 }, 1);
+  lattice.evaluate();
+
+  // Reaching x = 5 - 1 - 0.6 stops the ship at thrust 3.
+  ASSERT_EQ(3, lattice.max_static_thrust(0));
+  ASSERT_TRUE(lattice.is_legal(3, 0));
+  ASSERT_FALSE(lattice.is_legal(4, 0));
+  ASSERT_EQ(7, lattice.max_static_thrust(180));
+
+  // The best move towards a target behind the obstacle goes around it.
+  const auto move = lattice.best(DistanceToTarget{ { 10, 0 } });
+  ASSERT_TRUE(lattice.is_legal(move.thrust(), move.angle_in_degrees()));
+  ASSERT_NE(0, move.angle_in_degrees());
+}
+
+TEST(raf_move_lattice, boxed_in_stands_still)
+{
+  MoveLattice lattice({ 0, 0 });
+  for (int angle = 0; angle < 360; angle += 10) {
+    lattice.add_obstacle(MoveTable::instance().displacement(1, angle) * 1.5, 0.5);
+  }
+  lattice.evaluate();
+  ASSERT_EQ(1, lattice.legal_moves());
+  ASSERT_EQ(0, lattice.best(DistanceToTarget{ { 10, 10 } }).thrust());
+}
+
+TEST(raf_move_lattice, threat_exposure)
+{
+  MoveLattice lattice({ 50, 50 });
+  lattice.evaluate();
+
+  // Threat sits to the east, the target just past it.
+  const ThreatExposure threats{ { { 58, 50 } }, 6.0, 1000.0 };
+  const DistanceToTarget distance{ { 58, 50 } };
+  const auto move = lattice.best([&](const Velocity& v, const Vec2d& end) {
+    return threats(v, end) + distance(v, end);
+  });
+  const auto end = Vec2d(50, 50) + move.to_vec();
+  ASSERT_GT((end - Vec2d(58, 50)).length(), 6.0);
+  ASSERT_LT((end - Vec2d(58, 50)).length(), 6.2);
+}
+
+// Every move the lattice allows passes the greedy navigator's own checks, and
+// every move it rejects fails one of them.
+TEST(raf_move_lattice, matches_exact_checks)
+{
+  std::mt19937 rng(13);
+  std::uniform_real_distribution<double> offset(-12, 12);
+  std::uniform_real_distribution<double> radius(0.5, 4);
+  std::uniform_real_distribution<double> step(-7, 7);
+  const Vec2d start(100, 100);
+  const double fudge = raf::constants::FORECAST_FUDGE_FACTOR;
+
+  for (int scene = 0; scene < 40; scene++) {
+    std::vector<Circle> circles;
+    std::vector<Path> paths;
+    MoveLattice lattice(start);
+    for (int i = 0; i < 6; i++) {
+      const Circle c = { start + Vec2d(offset(rng), offset(rng)), radius(rng) };
+      circles.push_back(c);
+      lattice.add_obstacle(c.center, c.radius);
+    }
+    for (int i = 0; i < 3; i++) {
+      const Vec2d path_start = start + Vec2d(offset(rng), offset(rng));
+      const Path path(100 + i, path_start, path_start + Vec2d(step(rng), step(rng)), 0.5);
+      paths.push_back(path);
+      lattice.add_path(path);
+    }
+    lattice.evaluate();
+
+    for (int angle = 0; angle < 360; angle++) {
+      bool static_blocked = false;
+      for (int thrust = 1; thrust <= raf::constants::MAX_SPEED; thrust++) {
+        const Vec2d end = start + MoveTable::instance().displacement(thrust, angle);
+        for (const auto& c : circles) {
+          static_blocked = static_blocked || raf::collision::segment_circle_intersect(start, end, c.center, fudge, c.radius);
+        }
+        const bool path_blocked = raf::navigation::collides_with_any_path(paths, start, end);
+        ASSERT_EQ(!static_blocked && !path_blocked, lattice.is_legal(thrust, angle))
+          << "scene " << scene << " thrust " << thrust << " angle " << angle;
+      }
+    }
+  }
+}
+
+TEST(raf_move_lattice, navigate_on_lattice)
+{
+  const std::vector<Planet> planets = { Planet(0, INVALID_ENTITIY_ID, { 20, 10 }, 5, 1000, 3) };
+  const Ship ship(0, 1, { 10, 10 }, raf::constants::SHIP_RADIUS, 255);
+  const Ship mover(0, 2, { 10, 13 }, raf::constants::SHIP_RADIUS, 255);
+  const Ship parked(1, 3, { 10, 6 }, raf::constants::SHIP_RADIUS, 255);
+  const std::vector<Ship> ships = { ship, mover, parked };
+
+  raf::game::PendingPaths pending;
+  pending.push_back(Path(mover, Velocity(7, 90)));
+
+  const auto move = raf::navigation::navigate_ship_on_lattice(
+    planets, ships, ship.current_location(), raf::constants::MAX_SPEED, pending, DistanceToTarget{ { 30, 10 } });
+  ASSERT_GT(move.thrust(), 0);
+
+  const Vec2d end = ship.current_location() + move.to_vec();
+  ASSERT_TRUE(raf::navigation::objects_between(planets, ships, ship.current_location(), end).empty());
+  ASSERT_FALSE(raf::navigation::collides_with_any_path(pending, ship.current_location(), end));
+}
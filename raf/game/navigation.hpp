@@ -1,10 +1,15 @@
 #ifndef RAF_GAME_NAVIGATION_H_
 #define RAF_GAME_NAVIGATION_H_
 
+#include "blocked_arcs.hpp"
 #include "collision.hpp"
 #include "path.hpp"
+#include "pending_paths.hpp"
 #include "entity.hpp"
+#include "frame_arena.hpp"
+#include "move_lattice.hpp"
 #include "planet.hpp"
+#include "planet_index.hpp"
 #include "ship.hpp"
 #include "../log.hpp"
 #include "../types.hpp"
@@ -61,43 +66,190 @@ namespace raf {
       return entities_found;
     }
 
-    static bool would_collide_in_transit(
-      const std::vector<game::Planet> &planets,
+    // As above, but only planets near the segment are tested.
+    static std::vector<const Entity *> objects_between(
+      const game::PlanetIndex &planets,
       const std::vector<game::Ship> &ships,
       const Vec2d& start,
-      const Vec2d& target,
-      const std::vector<game::Path>& pending_moves) {
+      const Vec2d& target) {
+      std::vector<const Entity *> entities_found;
+
+      planets.for_each_on_segment(start, target, constants::FORECAST_FUDGE_FACTOR, [&](const Entity& planet) {
+        check_and_add_entity_between(entities_found, start, target, planet);
+      });
+
+      for (const auto& ship : ships) {
+        check_and_add_entity_between(entities_found, start, target, ship);
+      }
+
+      return entities_found;
+    }
+
+    // Same answer as objects_between(planets, ships, start, target).empty(),
+    // with the ships tested as a batch. ship_circles must hold the ships in
+    // the same order.
+    template<typename PlanetSet>
+    static bool is_path_clear(
+      const PlanetSet &planets,
+      const game::FrameVector<const game::Ship*> &ships,
+      const collision::CircleSet &ship_circles,
+      const Vec2d& start,
+      const Vec2d& target) {
+      if (!objects_between(planets, std::vector<game::Ship>(), start, target).empty()) {
+        return false;
+      }
 
+      int hit = collision::first_segment_circle_hit(start, target, ship_circles, constants::FORECAST_FUDGE_FACTOR);
+      while (hit >= 0) {
+        // objects_between ignores anything sat exactly on the end points.
+        const auto& location = ships[hit]->current_location();
+        if (!(location == start) && !(location == target)) {
+          return false;
+        }
+        hit = collision::first_segment_circle_hit(start, target, ship_circles, constants::FORECAST_FUDGE_FACTOR, hit + 1);
+      }
+      return true;
+    }
+
+    // Call func(const game::Planet&) for every planet that could be within reach of start.
+    template<typename Func>
+    static void for_each_planet_in_reach(
+      const std::vector<game::Planet> &planets,
+      const Vec2d& start,
+      double reach,
+      Func func) {
+      for (const auto& planet : planets) {
+        func(planet);
+      }
+    }
+
+    template<typename Func>
+    static void for_each_planet_in_reach(
+      const game::PlanetIndex &planets,
+      const Vec2d& start,
+      double reach,
+      Func func) {
+      // Pad the range a little, in_range is strict on the planet edge.
+      planets.for_each_in_range(start, reach + constants::FORECAST_FUDGE_FACTOR + 1.0, func);
+    }
+
+    // Add the arcs blocked by every planet that could be within reach.
+    template<typename PlanetSet>
+    static void add_blocked_arcs(
+      BlockedArcs& arcs,
+      const PlanetSet &planets,
+      const Vec2d& start,
+      double reach) {
+      for_each_planet_in_reach(planets, start, reach, [&](const game::Planet& planet) {
+        arcs.add(planet.current_location(), planet.radius() + constants::FORECAST_FUDGE_FACTOR);
+      });
+    }
+
+    // Closest approach test of our move start->target against a committed path.
+    static bool collides_with_path(const game::Path& move, const Vec2d& start, const Vec2d& target) {
+      auto our_vel = target - start;
+      auto dist = sqrt(min_dist_squared(
+        move.start_pos,
+        move.end_pos - move.start_pos,
+        start,
+        our_vel));
+      if (dist < move.radius * game::PATH_CLEARANCE_FACTOR)
+      {
+        raf::Log("distance : ", dist);
+        return true;
+      }
+      return false;
+    }
+
+    static bool collides_with_any_path(
+      const std::vector<game::Path>& pending_moves,
+      const Vec2d& start,
+      const Vec2d& target) {
       for (const auto& move : pending_moves) {
-        auto our_vel = target - start;
-        auto dist = sqrt(min_dist_squared(
-          move.start_pos,
-          move.end_pos - move.start_pos,
-          start,
-          our_vel));
-        if (dist < move.radius * 2.1)
-        {
-          raf::Log("distance : ", dist);
+        if (collides_with_path(move, start, target)) {
           return true;
         }
       }
       return false;
     }
 
+    // Only paths whose swept boxes overlap ours reach the exact test.
+    static bool collides_with_any_path(
+      const game::PendingPaths& pending_moves,
+      const Vec2d& start,
+      const Vec2d& target) {
+      return pending_moves.any_near(start, target, [&](const game::Path& move) {
+        return collides_with_path(move, start, target);
+      });
+    }
+
+    template<typename PlanetSet, typename ShipSet, typename PathSet>
+    static bool would_collide_in_transit(
+      const PlanetSet &planets,
+      const ShipSet &ships,
+      const Vec2d& start,
+      const Vec2d& target,
+      const PathSet& pending_moves) {
+      return collides_with_any_path(pending_moves, start, target);
+    }
+
+    // Alternative to navigate_ship_towards_target that scores every legal
+    // move with cost(const math::Velocity&, const Vec2d& end) and returns the
+    // cheapest. Obstacles are the same as the greedy sweep: planets, ships
+    // without a pending move, and the pending moves themselves. Also the
+    // fallback for navigate_ship_towards_target once its corrections run out.
+    //
+    // Always succeeds, standing still is legal when nothing else is.
+    template<typename PlanetSet, typename ShipSet, typename PathSet, typename Cost>
+    static math::Velocity navigate_ship_on_lattice(
+      const PlanetSet &planets,
+      const ShipSet &ships,
+      const Vec2d& ship,
+      const int max_thrust,
+      const PathSet& pending_moves,
+      Cost cost)
+    {
+      MoveLattice lattice(ship, max_thrust);
+      for_each_planet_in_reach(planets, ship, max_thrust, [&](const game::Planet& planet) {
+        lattice.add_obstacle(planet.current_location(), planet.radius());
+      });
+      for (const auto& e : ships) {
+        bool moves_this_frame = false;
+        for (const auto& mover : pending_moves) {
+          if (mover.ship_id == e.id()) {
+            moves_this_frame = true;
+          }
+        }
+        if (!moves_this_frame) {
+          lattice.add_obstacle(e.current_location(), e.radius());
+        }
+      }
+      for (const auto& path : pending_moves) {
+        lattice.add_path(path);
+      }
+      lattice.evaluate();
+      return lattice.best(cost);
+    }
+
     // Refactor this
     // Change planets to be a set of planet id's to test against
     // Change ships to be a set of ship id's to test against.
     // Leave pending moves as is
+    //
+    // planets may be a std::vector<game::Planet> or a game::PlanetIndex.
+    // ships may be a std::vector<game::Ship> or a game::EntityView<game::Ship>.
+    // pending_moves may be a std::vector<game::Path> or a game::PendingPaths.
+    template<typename PlanetSet = std::vector<game::Planet>, typename PathSet = std::vector<game::Path>, typename ShipSet = std::vector<game::Ship>>
     static possibly<math::Velocity> navigate_ship_towards_target(
-      const std::vector<game::Planet> &planets,
-      const std::vector<game::Ship> &ships,
+      const PlanetSet &planets,
+      const ShipSet &ships,
       const Vec2d& ship,
       const Vec2d& target,
       const int max_thrust,
       const bool avoid_obstacles,
       const int max_corrections,
       const double angular_step_rad,
-      const std::vector<game::Path>& pending_moves)
+      const PathSet& pending_moves)
     {
       if (max_corrections <= 0) {
         return { math::Velocity(0, 0), false };
@@ -116,7 +268,8 @@ namespace raf {
       const double distance = navigation::distance(ship, target);
       double angle_rad = ship.orient_towards_in_rad(target);
 
-      std::vector<game::Ship> stripped_ships;
+      game::FrameVector<const game::Ship*> stripped_ships;
+      collision::CircleSet stripped_circles;
       for (const auto &e : ships) {
         bool moves_this_frame = false;
         for (const auto &mover : pending_moves) {
@@ -126,28 +279,48 @@ namespace raf {
         }
 
         if (!moves_this_frame) {
-          stripped_ships.push_back(e);
+          stripped_ships.push_back(&e);
+          stripped_circles.push_back(e.current_location(), e.radius());
         }
       }
 
-      if (avoid_obstacles && !objects_between(planets, stripped_ships, ship, target).empty()) {
+      if (avoid_obstacles && !is_path_clear(planets, stripped_ships, stripped_circles, ship, target)) {
+        // Work out which headings each obstacle blocks up front, so most
+        // corrections are settled without testing every obstacle.
+        BlockedArcs arcs(ship, distance);
+        add_blocked_arcs(arcs, planets, ship, distance);
+        for (const auto* e : stripped_ships) {
+          arcs.add(e->current_location(), e->radius() + constants::FORECAST_FUDGE_FACTOR);
+        }
+        arcs.merge();
+
         bool found = false;
         for (int i = 0; i < max_corrections; i++) {
           // If i is even go clockwise, else go anti clockwise
           // Make sure all intervals are performed both anti and counter clockwise
           double adjustment_angle = (i % 2 == 0) ? angular_step_rad * (i + 2)/2 : -angular_step_rad * (i + 2) / 2;
+          const auto heading = arcs.classify(angle_rad + adjustment_angle);
+          if (heading == BlockedArcs::Heading::Blocked) {
+            continue;
+          }
+
           const double new_target_dx = cos(angle_rad + adjustment_angle) * distance;
           const double new_target_dy = sin(angle_rad + adjustment_angle) * distance;
           adjusted_target = { ship.x() + new_target_dx, ship.y() + new_target_dy };
 
-          if (objects_between(planets, stripped_ships, ship, adjusted_target).empty()) {
+          if (heading == BlockedArcs::Heading::Free
+            || is_path_clear(planets, stripped_ships, stripped_circles, ship, adjusted_target)) {
             angle_rad = angle_rad + adjustment_angle;
             found = true;
             break;
           }
         }
         if (!found) {
-          return { math::Velocity(0, 0), false };
+          // Every correction is blocked, take whichever legal move gets
+          // closest instead. Standing still is still reported as no move.
+          const auto fallback = navigate_ship_on_lattice(
+            planets, ships, ship, max_thrust, pending_moves, DistanceToTarget{ target });
+          return { fallback, fallback.thrust() > 0 };
         }
       }
 
@@ -173,29 +346,29 @@ namespace raf {
 
       {
         const double angle_rad = ship.orient_towards_in_rad(adjusted_target);
-        const double new_target_dx = cos(angle_rad) * thrust;
-        const double new_target_dy = sin(angle_rad) * thrust;
-        Vec2d new_target = { ship.x() + new_target_dx, ship.y() + new_target_dy };
+        const double cos_angle = cos(angle_rad);
+        const double sin_angle = sin(angle_rad);
+        Vec2d new_target = { ship.x() + cos_angle * thrust, ship.y() + sin_angle * thrust };
         while (would_collide_in_transit(planets, ships, ship, new_target, pending_moves) && thrust > 0) {
           // If a collision would happen, reduce thrust by 1.
           thrust -= 1;
-          const double new_target_dx = cos(angle_rad) * thrust;
-          const double new_target_dy = sin(angle_rad) * thrust;
-          new_target = { ship.x() + new_target_dx, ship.y() + new_target_dy };
+          new_target = { ship.x() + cos_angle * thrust, ship.y() + sin_angle * thrust };
         }
       }
 
-      raf::Log("result vector=", math::Velocity(thrust, angle_deg).to_vec());
-      return { math::Velocity(thrust, angle_deg), true };
+      const math::Velocity velocity(thrust, angle_deg);
+      raf::Log("result vector=", velocity.to_vec());
+      return { velocity, true };
     }
 
+    template<typename PlanetSet = std::vector<game::Planet>, typename PathSet = std::vector<game::Path>, typename ShipSet = std::vector<game::Ship>>
     static possibly<math::Velocity> navigate_ship_to_dock(
-      const std::vector<game::Planet> &planets,
-      const std::vector<game::Ship> &ships,
+      const PlanetSet &planets,
+      const ShipSet &ships,
       const Entity& ship,
       const Entity& dock_target,
       const int max_thrust,
-      const std::vector<game::Path>& pending_moves)
+      const PathSet& pending_moves)
     {
       const int max_corrections = constants::MAX_NAVIGATION_CORRECTIONS;
       const bool avoid_obstacles = true;
@@ -208,13 +381,14 @@ namespace raf {
         planets, ships, ship.current_location(), target, max_thrust, avoid_obstacles, max_corrections, angular_step_rad, pending_moves);
     }
 
+    template<typename PlanetSet = std::vector<game::Planet>, typename PathSet = std::vector<game::Path>, typename ShipSet = std::vector<game::Ship>>
     static possibly<math::Velocity> navigate_ship_to_attack(
-      const std::vector<game::Planet> &planets,
-      const std::vector<game::Ship> &ships,
+      const PlanetSet &planets,
+      const ShipSet &ships,
       const Entity& ship,
       const Entity& target,
       const int max_thrust,
-      const std::vector<game::Path>& pending_moves)
+      const PathSet& pending_moves)
     {
       const int max_corrections = constants::MAX_NAVIGATION_CORRECTIONS;
       const bool avoid_obstacles = true;
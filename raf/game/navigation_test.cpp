@@ -0,0 +1,144 @@
+#include "navigation.hpp"
+#include "entity.hpp"
+#include "path.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include "hlt/move.hpp"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::Path;
+using raf::game::Planet;
+using raf::game::Ship;
+using raf::math::Vec2d;
+
+// The closest point helpers as they were, placing the point with atan2, cos
+// and sin.
+static Vec2d point_towards_trig(const Vec2d& origin, const Vec2d& towards, double radius) {
+  const double angle_rad = origin.orient_towards_in_rad(towards);
+  return { origin.x() + radius * std::cos(angle_rad), origin.y() + radius * std::sin(angle_rad) };
+}
+
+static hlt::Move to_move(const raf::game::Entity& ship, const raf::possibly<raf::math::Velocity>& velocity) {
+  if (!velocity.second) {
+    return hlt::Move::noop();
+  }
+  return hlt::Move::thrust(ship.id(), velocity.first.thrust(), velocity.first.angle_in_degrees());
+}
+
+static void expect_same_move(const hlt::Move& expected, const hlt::Move& actual, int scene) {
+  ASSERT_EQ(expected.type, actual.type) << "scene " << scene;
+  ASSERT_EQ(expected.move_thrust, actual.move_thrust) << "scene " << scene;
+  ASSERT_EQ(expected.move_angle_deg, actual.move_angle_deg) << "scene " << scene;
+}
+
+static raf::possibly<raf::math::Velocity> navigate_to(
+  const std::vector<Planet>& planets,
+  const std::vector<Ship>& ships,
+  const Ship& ship,
+  const Vec2d& target) {
+  return raf::navigation::navigate_ship_towards_target(
+    planets, ships, ship.current_location(), target, raf::constants::MAX_SPEED, true,
+    raf::constants::MAX_NAVIGATION_CORRECTIONS, raf::math::degrees_to_rads(2), std::vector<Path>());
+}
+
+// Switching the closest point helpers to point_towards must not change a
+// single emitted move. get_closest_point and nearest_dock_point stay on the
+// trig path for that reason, these checks keep them there.
+TEST(raf_navigation, closest_points_keep_moves)
+{
+  std::mt19937 rng(21);
+  std::uniform_real_distribution<double> coordinate(20, 220);
+  std::uniform_real_distribution<double> planet_radius(3, 12);
+  std::uniform_real_distribution<double> offset(-40, 40);
+
+  for (int scene = 0; scene < 3000; scene++) {
+    std::vector<Planet> planets;
+    for (int i = 0; i < 4; i++) {
+      planets.push_back(Planet(i, INVALID_ENTITIY_ID, { coordinate(rng), coordinate(rng) }, planet_radius(rng), 1000, 3));
+    }
+    const Planet& dock_target = planets[0];
+    const Ship ship(0, 10, dock_target.current_location() + Vec2d(offset(rng), offset(rng)), raf::constants::SHIP_RADIUS, 255);
+    const Ship enemy(1, 11, ship.current_location() + Vec2d(offset(rng), offset(rng)), raf::constants::SHIP_RADIUS, 255);
+    const std::vector<Ship> ships = { ship, enemy };
+
+    // navigate_ship_to_dock via get_closest_point.
+    const auto dock_point = point_towards_trig(
+      dock_target.current_location(), ship.current_location(), dock_target.radius() + raf::constants::MIN_DISTANCE_FOR_CLOSEST_POINT);
+    expect_same_move(
+      to_move(ship, navigate_to(planets, ships, ship, dock_point)),
+      to_move(ship, raf::navigation::navigate_ship_to_dock(planets, ships, ship, dock_target, raf::constants::MAX_SPEED, std::vector<Path>())),
+      scene);
+
+    // navigate_ship_to_attack via get_closest_point.
+    const auto attack_point = point_towards_trig(
+      enemy.current_location(), ship.current_location(), raf::constants::WEAPON_RADIUS - 1.0 + raf::constants::MIN_DISTANCE_FOR_CLOSEST_POINT);
+    expect_same_move(
+      to_move(ship, navigate_to(planets, ships, ship, attack_point)),
+      to_move(ship, raf::navigation::navigate_ship_to_attack(planets, ships, ship, enemy, raf::constants::MAX_SPEED, std::vector<Path>())),
+      scene);
+
+    // nearest_attack_point and nearest_dock_point.
+    const auto attack_trig = point_towards_trig(
+      enemy.current_location(), ship.current_location(), enemy.radius() + raf::constants::WEAPON_RADIUS);
+    expect_same_move(
+      to_move(ship, navigate_to(planets, ships, ship, attack_trig)),
+      to_move(ship, navigate_to(planets, ships, ship, raf::game::nearest_attack_point(enemy, ship))),
+      scene);
+    const auto dock_trig = point_towards_trig(
+      dock_target.current_location(), ship.current_location(), dock_target.radius() + raf::constants::MIN_DISTANCE_FOR_CLOSEST_POINT);
+    expect_same_move(
+      to_move(ship, navigate_to(planets, ships, ship, dock_trig)),
+      to_move(ship, navigate_to(planets, ships, ship, raf::game::nearest_dock_point(dock_target, ship))),
+      scene);
+  }
+}
+
+TEST(raf_navigation, spawn_point_faces_center)
+{
+  const Planet planet(0, INVALID_ENTITIY_ID, { 50, 40 }, 5, 1000, 3);
+  const auto spawn = raf::game::spawn_point(planet, 240, 80);
+  // Center is (120, 40), directly to the right.
+  ASSERT_DOUBLE_EQ(50 + 5 + raf::constants::MIN_DISTANCE_FOR_CLOSEST_POINT, spawn.x());
+  ASSERT_DOUBLE_EQ(40, spawn.y());
+}
+
+TEST(raf_navigation, lattice_fallback_when_corrections_run_out)
+{
+  // A planet dead ahead, with too few corrections to steer round it.
+  const std::vector<Planet> planets = { Planet(0, INVALID_ENTITIY_ID, { 60, 50 }, 6, 1000, 3) };
+  const Ship ship(0, 10, { 50, 50 }, raf::constants::SHIP_RADIUS, 255);
+  const std::vector<Ship> ships = { ship };
+  const Vec2d target(80, 50);
+
+  const auto velocity = raf::navigation::navigate_ship_towards_target(
+    planets, ships, ship.current_location(), target, raf::constants::MAX_SPEED, true,
+    2, raf::math::degrees_to_rads(2), std::vector<Path>());
+  ASSERT_TRUE(velocity.second);
+  const auto end = ship.current_location() + velocity.first.to_vec();
+  ASSERT_LT((end - target).length(), (ship.current_location() - target).length());
+  ASSERT_GT((end - planets[0].current_location()).length(), planets[0].radius());
+
+  // Boxed in, the fallback stands still and that is still no move.
+  const std::vector<Ship> boxed = {
+    ship,
+    Ship(1, 10, { 51.2, 50 }, raf::constants::SHIP_RADIUS, 255),
+    Ship(2, 10, { 48.8, 50 }, raf::constants::SHIP_RADIUS, 255),
+    Ship(3, 10, { 50, 51.2 }, raf::constants::SHIP_RADIUS, 255),
+    Ship(4, 10, { 50, 48.8 }, raf::constants::SHIP_RADIUS, 255),
+    Ship(5, 10, { 50.85, 50.85 }, raf::constants::SHIP_RADIUS, 255),
+    Ship(6, 10, { 49.15, 50.85 }, raf::constants::SHIP_RADIUS, 255),
+    Ship(7, 10, { 50.85, 49.15 }, raf::constants::SHIP_RADIUS, 255),
+    Ship(8, 10, { 49.15, 49.15 }, raf::constants::SHIP_RADIUS, 255),
+  };
+  const auto stuck = raf::navigation::navigate_ship_towards_target(
+    planets, boxed, ship.current_location(), target, raf::constants::MAX_SPEED, true,
+    2, raf::math::degrees_to_rads(2), std::vector<Path>());
+  ASSERT_FALSE(stuck.second);
+}
@@ -0,0 +1,132 @@
+#ifndef RAF_GAME_NEAREST_H_
+#define RAF_GAME_NEAREST_H_
+
+#include "entity.hpp"
+#include "ship.hpp"
+#include "../math/math.hpp"
+#include "../types.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Optional restrictions for nearest neighbour queries.
+// Unset fields match everything.
+struct NearestFilter {
+  // Only entities owned by this player.
+  possibly<EntityId> owner = { INVALID_ENTITIY_ID, false };
+  // Skip entities owned by this player.
+  possibly<EntityId> not_owner = { INVALID_ENTITIY_ID, false };
+  // Only ships in this docking state. Ignored for other entity types.
+  possibly<DockingStatus> docking_status = { DockingStatus::Undocked, false };
+
+  static NearestFilter owned_by(EntityId player) {
+    NearestFilter filter;
+    filter.owner = { player, true };
+    return filter;
+  }
+
+  static NearestFilter not_owned_by(EntityId player) {
+    NearestFilter filter;
+    filter.not_owner = { player, true };
+    return filter;
+  }
+
+  NearestFilter& with_docking_status(DockingStatus status) {
+    docking_status = { status, true };
+    return *this;
+  }
+
+  bool operator()(const Entity& entity) const {
+    if (owner.second && entity.owner() != owner.first) {
+      return false;
+    }
+    if (not_owner.second && entity.owner() == not_owner.first) {
+      return false;
+    }
+    return true;
+  }
+
+  bool operator()(const Ship& ship) const {
+    if (docking_status.second && ship.docking_status() != docking_status.first) {
+      return false;
+    }
+    return (*this)(static_cast<const Entity&>(ship));
+  }
+};
+
+// Visits entities in order of increasing center distance from an origin.
+//
+// Building the order is a linear pass plus a heap build, each call to next()
+// is O(log n). Callers that only want the closest one or few entities pay for
+// what they read rather than a full sort. Ties are broken by id, so the order
+// is deterministic.
+//
+// Entities are referenced by id, nothing is copied.
+class NearestOrder {
+public:
+  template<typename Container, typename Filter = NearestFilter>
+  NearestOrder(const Container& entities, const math::Vec2d& origin, Filter accept = Filter()) {
+    candidates_.reserve(entities.size());
+    for (const auto& e : entities) {
+      const auto& entity = entity_of(e);
+      if (accept(entity)) {
+        candidates_.push_back({ (entity.current_location() - origin).length_squared(), entity.id() });
+      }
+    }
+    std::make_heap(std::begin(candidates_), std::end(candidates_), std::greater<Candidate>());
+  }
+
+  bool empty() const { return candidates_.empty(); }
+  size_t size() const { return candidates_.size(); }
+
+  // Id of the nearest entity not yet returned. Must not be empty().
+  EntityId next() {
+    std::pop_heap(std::begin(candidates_), std::end(candidates_), std::greater<Candidate>());
+    const auto id = candidates_.back().second;
+    candidates_.pop_back();
+    return id;
+  }
+
+  // Up to k ids of the nearest entities not yet returned, nearest first.
+  std::vector<EntityId> take(size_t k) {
+    std::vector<EntityId> ids;
+    ids.reserve(std::min(k, size()));
+    while (ids.size() < k && !empty()) {
+      ids.push_back(next());
+    }
+    return ids;
+  }
+
+private:
+  // Squared distance, id.
+  using Candidate = std::pair<double, EntityId>;
+
+  template<typename T>
+  static const T& entity_of(const T& entity) { return entity; }
+  template<typename T>
+  static const T& entity_of(const std::pair<const EntityId, T>& e) { return e.second; }
+
+  std::vector<Candidate> candidates_;
+};
+
+// Ids of the k entities nearest to origin that pass accept, nearest first.
+// Works on vectors of entities or maps keyed by EntityId.
+template<typename Container, typename Filter = NearestFilter>
+std::vector<EntityId> k_nearest(
+  const Container& entities,
+  const math::Vec2d& origin,
+  size_t k,
+  Filter accept = Filter()) {
+  return NearestOrder(entities, origin, accept).take(k);
+}
+
+}
+}
+
+#endif // !RAF_GAME_NEAREST_H_
@@ -0,0 +1,110 @@
+#include "nearest.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using raf::game::EntityId;
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::k_nearest;
+using raf::game::NearestFilter;
+using raf::game::NearestOrder;
+using raf::game::Planet;
+using raf::game::Ship;
+using raf::math::Vec2d;
+
+TEST(raf_nearest, empty)
+{
+  const std::vector<Ship> ships;
+  ASSERT_TRUE(k_nearest(ships, { 0, 0 }, 3).empty());
+}
+
+TEST(raf_nearest, matches_full_sort)
+{
+  std::map<EntityId, Ship> ships;
+  EntityId id = 0;
+  for (double x = 0.5; x < 200; x += 13.7) {
+    for (double y = 0.5; y < 120; y += 9.1) {
+      ships.emplace(id, Ship(id, id % 3, Vec2d{ x, y }, 0.5, 255));
+      id++;
+    }
+  }
+
+  const Vec2d origin(77.7, 43.1);
+  std::vector<Ship> sorted;
+  for (const auto& e : ships) {
+    sorted.push_back(e.second);
+  }
+  std::stable_sort(std::begin(sorted), std::end(sorted), [&origin](const Ship& a, const Ship& b) {
+    return a.distance_to(origin) < b.distance_to(origin);
+  });
+
+  const auto nearest = k_nearest(ships, origin, 10);
+  ASSERT_EQ(10, nearest.size());
+  for (size_t i = 0; i < nearest.size(); i++) {
+    ASSERT_EQ(sorted[i].id(), nearest[i]);
+  }
+
+  // Asking for more than exist returns everything.
+  ASSERT_EQ(ships.size(), k_nearest(ships, origin, 1000).size());
+}
+
+TEST(raf_nearest, ties_break_on_id)
+{
+  const std::vector<Ship> ships = {
+    Ship(5, 0, { 10, 0 }, 0.5, 255),
+    Ship(2, 0, { -10, 0 }, 0.5, 255),
+    Ship(9, 0, { 0, 10 }, 0.5, 255),
+  };
+  ASSERT_EQ((std::vector<EntityId>{ 2, 5, 9 }), k_nearest(ships, { 0, 0 }, 3));
+}
+
+TEST(raf_nearest, owner_filters)
+{
+  const std::vector<Ship> ships = {
+    Ship(0, 0, { 1, 0 }, 0.5, 255),
+    Ship(1, 1, { 2, 0 }, 0.5, 255),
+    Ship(2, 2, { 3, 0 }, 0.5, 255),
+    Ship(3, 1, { 4, 0 }, 0.5, 255),
+  };
+  ASSERT_EQ((std::vector<EntityId>{ 1, 3 }), k_nearest(ships, { 0, 0 }, 5, NearestFilter::owned_by(1)));
+  ASSERT_EQ((std::vector<EntityId>{ 1, 2 }), k_nearest(ships, { 0, 0 }, 2, NearestFilter::not_owned_by(0)));
+
+  const std::vector<Planet> planets = {
+    Planet(0, INVALID_ENTITIY_ID, { 10, 0 }, 3, 1000, 2),
+    Planet(1, 1, { 20, 0 }, 3, 1000, 2),
+  };
+  ASSERT_EQ((std::vector<EntityId>{ 1 }), k_nearest(planets, { 0, 0 }, 2, NearestFilter::owned_by(1)));
+}
+
+TEST(raf_nearest, docking_status_filter)
+{
+  // Constructed ships are undocked.
+  const std::vector<Ship> ships = {
+    Ship(0, 0, { 1, 0 }, 0.5, 255),
+    Ship(1, 1, { 2, 0 }, 0.5, 255),
+  };
+  auto filter = NearestFilter::not_owned_by(0).with_docking_status(raf::game::DockingStatus::Undocked);
+  ASSERT_EQ((std::vector<EntityId>{ 1 }), k_nearest(ships, { 0, 0 }, 2, filter));
+
+  filter.with_docking_status(raf::game::DockingStatus::Docked);
+  ASSERT_TRUE(k_nearest(ships, { 0, 0 }, 2, filter).empty());
+}
+
+TEST(raf_nearest, order_is_incremental)
+{
+  const std::vector<Ship> ships = {
+    Ship(0, 0, { 3, 0 }, 0.5, 255),
+    Ship(1, 0, { 1, 0 }, 0.5, 255),
+    Ship(2, 0, { 2, 0 }, 0.5, 255),
+  };
+  NearestOrder order(ships, { 0, 0 }, [](const Ship& s) { return s.id() != 2; });
+  ASSERT_EQ(2, order.size());
+  ASSERT_EQ(1, order.next());
+  ASSERT_EQ(0, order.next());
+  ASSERT_TRUE(order.empty());
+}
@@ -1,13 +1,17 @@
 #ifndef RAF_GAME_PATH_FINDER_H_
 #define RAF_GAME_PATH_FINDER_H_
 
+#include "area_search.hpp"
 #include "collision.hpp"
 #include "constants.hpp"
 #include "path.hpp"
 #include "entity.hpp"
+#include "entity_store.hpp"
 #include "navigation.hpp"
 #include "planet.hpp"
+#include "planet_index.hpp"
 #include "ship.hpp"
+#include "hierarchical_grid.hpp"
 
 #include "../stdlib_util.h"
 #include <vector>
@@ -21,38 +25,38 @@ namespace navigation {
 // edge_distance_to_edge - calculate the minimum distances between edges based on orgin + object radius
 //    useful for calculating whether edges will touch
 
-double distance_to_point(const math::Vec2d& a, const math::Vec2d& b) {
+inline double distance_to_point(const math::Vec2d& a, const math::Vec2d& b) {
   const auto delta = a - b;
   return delta.length();
 }
 
-double distance_to_point(const game::Entity& a, const game::Entity& b) {
+inline double distance_to_point(const game::Entity& a, const game::Entity& b) {
   return distance_to_point(a.current_location(), b.current_location());
 }
 
 // returns negative if within radius
-double distance_to_radius(const math::Vec2d& a, const math::Vec2d& b, double radius) {
+inline double distance_to_radius(const math::Vec2d& a, const math::Vec2d& b, double radius) {
   return distance_to_point(a, b) - radius;
 }
 
-double distance_to_radius(const game::Entity& a, const game::Entity& b, double radius) {
+inline double distance_to_radius(const game::Entity& a, const game::Entity& b, double radius) {
   return distance_to_radius(a.current_location(), b.current_location(), radius);
 }
 
 // Calculate the distance to the edge of another entity
 // If this is negative then the objects have collided.
-double edge_distance_to_edge(const game::Entity& a, const game::Entity& b) {
+inline double edge_distance_to_edge(const game::Entity& a, const game::Entity& b) {
   //const auto point_distance = distance_to_point(a, b);
   //return point_distance - a.radius() - b.radius();
   const auto entity_radius = a.radius() + b.radius();
   return distance_to_radius(a, b, entity_radius);
 }
 // alias to
-const auto& collision_distance = edge_distance_to_edge;
+static const auto& collision_distance = edge_distance_to_edge;
 
 // Calculate the distance until two ships are in attack range
 // If negative they are already in attack range
-double weapon_distance_to_edge(const game::Ship& a, const game::Ship& b) {
+inline double weapon_distance_to_edge(const game::Ship& a, const game::Ship& b) {
   //const auto point_distance = distance_to_point(a, b);
   //const auto weapon_radius = constants::WEAPON_RADIUS + a.radius() + b.radius();
   //return point_distance - weapon_radius;
@@ -60,7 +64,7 @@ double weapon_distance_to_edge(const game::Ship& a, const game::Ship& b) {
   return distance_to_radius(a, b, weapon_radius);
 }
 
-bool could_attack_next_turn(const game::Ship& a, const game::Ship& b) {
+inline bool could_attack_next_turn(const game::Ship& a, const game::Ship& b) {
   // If two ships travel towards each other they will reduce distance by 2 * MAX_SPEED
   // Effectively this filters all ships that are within distance of
   //    2 * MAX_SPEED + a.radius() + b.radius() + WEAPON_RADIUS
@@ -71,14 +75,14 @@ bool could_attack_next_turn(const game::Ship& a, const game::Ship& b) {
 
 // Damage is dealt at start of turn if within radius
 // Determines whether two ships are within the radius required for damage to be applied.
-bool will_attack_next_turn(const game::Ship& a, const game::Ship& b) {
+inline bool will_attack_next_turn(const game::Ship& a, const game::Ship& b) {
   // Check the halite engine code to see what their exact calculation is.
   // Some of them don't seem unclear such as WEAPON radius being ship radius +
   // weapon radius rather than just radius from origin.
   return weapon_distance_to_edge(a, b) < 0;
 }
 
-double edge_distance_to_dock(const game::Ship& ship, const game::Planet& planet) {
+inline double edge_distance_to_dock(const game::Ship& ship, const game::Planet& planet) {
   const auto dock_radius = constants::DOCK_RADIUS + ship.radius() + planet.radius();
   return distance_to_radius(ship, planet, dock_radius);
 }
@@ -132,15 +136,17 @@ public:
   //        if a ship as a path pending, then its static location will not be
   //        tested for a collision, and the in transit collision algorithm will
   //        be used instead.
-  using planet_container = std::vector<game::Planet>;
-  using ship_container = std::vector<game::Ship>;
+  // planets and ships are views, so a MapState's stores can be passed without
+  // copying them into vectors.
+  using planet_container = game::EntityView<game::Planet>;
+  using ship_container = game::EntityView<game::Ship>;
   using pending_path_container = std::vector<game::Path>;
 
   // EUGH, might ditch this holding a reference idea.
   /// Pointers would potentially solve it however break constness
-  PathFinder(const planet_container& planets, const ship_container& ships, const pending_path_container&& pending_paths) = delete;
-  PathFinder(const planet_container& planets, const ship_container&& ships, const pending_path_container&& pending_paths) = delete;
-  PathFinder(const planet_container&& planets, const ship_container&& ships, const pending_path_container&& pending_paths) = delete;
+  PathFinder(const std::vector<game::Planet>& planets, const std::vector<game::Ship>& ships, const pending_path_container&& pending_paths) = delete;
+  PathFinder(const std::vector<game::Planet>& planets, const std::vector<game::Ship>&& ships, const pending_path_container&& pending_paths) = delete;
+  PathFinder(const std::vector<game::Planet>&& planets, const std::vector<game::Ship>&& ships, const pending_path_container&& pending_paths) = delete;
 
   // how do you stop binding of temporaries?
   // Seems the best way is require explicit passing to find
@@ -152,7 +158,26 @@ public:
     const pending_path_container& pending_paths)
     : planets_(planets),
     ships_(ships),
-    pending_paths_(pending_paths)
+    pending_paths_(pending_paths),
+    ship_grid_(nullptr),
+    planet_index_(nullptr)
+  {
+  }
+
+  // As above, but range queries are answered by ship_grid and planet_index
+  // rather than scanning every entity. Either may be null, and when given
+  // they must index the same entities as ships and planets.
+  PathFinder(
+    const planet_container& planets,
+    const ship_container& ships,
+    const pending_path_container& pending_paths,
+    const game::HierarchicalGrid<game::Ship>* ship_grid,
+    const game::PlanetIndex* planet_index = nullptr)
+    : planets_(planets),
+    ships_(ships),
+    pending_paths_(pending_paths),
+    ship_grid_(ship_grid),
+    planet_index_(planet_index)
   {
   }
 
@@ -200,6 +225,11 @@ private:
   }
 
   std::vector<game::Planet> planets_in_range(const game::Ship& ship, double range) const {
+    if (planet_index_) {
+      // Index measures to the planet edge, widen by our radius to match distance_to_edge.
+      return planet_index_->in_range(ship.current_location(), range + ship.radius());
+    }
+
     std::vector<game::Planet> in_range_planets;
     std::copy_if(
       std::begin(planets_),
@@ -215,6 +245,17 @@ private:
 
   std::vector<game::Ship> ships_in_range(const game::Ship& ship, double range) const {
     std::vector<game::Ship> in_range_ships;
+    if (ship_grid_) {
+      // Grid works on centers, so widen by both radii to cover edge distance.
+      const auto search_radius = range + ship.radius() + constants::SHIP_RADIUS;
+      ship_grid_->for_each_in_range(ship.current_location(), search_radius, [&](const game::Ship& s) {
+        if (ship.id() != s.id() && ship.distance_to_edge(s) < range) {
+          in_range_ships.push_back(s);
+        }
+      });
+      return in_range_ships;
+    }
+
     std::copy_if(
       std::begin(ships_),
       std::end(ships_),
@@ -228,17 +269,15 @@ private:
     return in_range_ships;
   }
 
-  const planet_container& planets_;
-  const ship_container& ships_;
+  planet_container planets_;
+  ship_container ships_;
   const pending_path_container& pending_paths_;
+  const game::HierarchicalGrid<game::Ship>* ship_grid_;
+  const game::PlanetIndex* planet_index_;
 
   std::map<game::EntityId, bool> has_pending_path_;
 };
 
-// As above but returns stats on what is in an area.
-class AreaSearch {
-};
-
 }
 }
 
@@ -5,6 +5,7 @@
 #include "raf/math/math.hpp"
 
 using raf::game::Entity;
+using raf::game::EntityId;
 using raf::game::Path;
 using raf::game::Planet;
 using raf::game::Ship;
@@ -201,3 +202,38 @@ TEST(raf_path_finder, path_finder_find)
   ASSERT_DOUBLE_EQ(result.first.end_pos.y(), 0);
 
 }
+
+TEST(raf_path_finder, path_finder_find_with_grid)
+{
+  const auto make_ship_at_location = [](EntityId id, Vec2d location) {
+    return Ship{ id, 0, location, 0.5, 255 };
+  };
+
+  const std::vector<Planet> planets{
+    Planet{ 100, 0,{ 20, 0 }, 5, 255, 0 },
+  };
+
+  const std::vector<Ship> ships{
+    make_ship_at_location(1, { 0, 10 }),
+    make_ship_at_location(2, { 0, -10 }),
+    make_ship_at_location(3, { 3, 0 }),
+    make_ship_at_location(4, { -10, 0 }),
+  };
+
+  raf::game::HierarchicalGrid<Ship> grid(raf::math::Vec2i(64, 64));
+  for (const auto& ship : ships) {
+    grid.insert(ship);
+  }
+
+  const std::vector<Path> paths;
+  const raf::navigation::PathFinder linear{ planets, ships, paths };
+  const raf::navigation::PathFinder gridded{ planets, ships, paths, &grid };
+  const auto my_ship = make_ship_at_location(0, { 0, 0 });
+
+  raf::navigation::PathFinderParams params;
+  const auto expected = linear.find(params, my_ship, { 7, 0 });
+  const auto result = gridded.find(params, my_ship, { 7, 0 });
+  ASSERT_EQ(expected.second, result.second);
+  ASSERT_DOUBLE_EQ(expected.first.end_pos.x(), result.first.end_pos.x());
+  ASSERT_DOUBLE_EQ(expected.first.end_pos.y(), result.first.end_pos.y());
+}
@@ -0,0 +1,59 @@
+#include "pending_paths.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace raf {
+namespace game {
+
+void PendingPaths::clear() {
+  paths_.clear();
+  sorted_.clear();
+  max_width_ = 0.0;
+}
+
+void PendingPaths::push_back(const Path& path) {
+  auto bounds = bounds_of(path.start_pos, path.end_pos, path.radius * PATH_CLEARANCE_FACTOR);
+  bounds.index = static_cast<int>(paths_.size());
+  paths_.push_back(path);
+
+  max_width_ = std::max(max_width_, bounds.max_x - bounds.min_x);
+  // One commit per ship per frame, so an ordered insert is cheaper than
+  // re-sorting before every query.
+  const auto it = std::upper_bound(std::begin(sorted_), std::end(sorted_), bounds.min_x, [](double x, const Bounds& b) {
+    return x < b.min_x;
+  });
+  sorted_.insert(it, bounds);
+}
+
+void PendingPaths::erase(EntityId ship_id) {
+  // Rare, only when a ship's move is replaced, so rebuild rather than keep
+  // the indices in sorted_ patched up.
+  auto kept = std::move(paths_);
+  clear();
+  for (const auto& path : kept) {
+    if (path.ship_id != ship_id) {
+      push_back(path);
+    }
+  }
+}
+
+PendingPaths::Bounds PendingPaths::bounds_of(const math::Vec2d& start, const math::Vec2d& end, double margin) {
+  return {
+    std::min(start.x(), end.x()) - margin,
+    std::max(start.x(), end.x()) + margin,
+    std::min(start.y(), end.y()) - margin,
+    std::max(start.y(), end.y()) + margin,
+    -1
+  };
+}
+
+std::vector<PendingPaths::Bounds>::const_iterator PendingPaths::first_candidate(double min_x) const {
+  // Nothing starting further left than the widest box can reach min_x.
+  return std::lower_bound(std::begin(sorted_), std::end(sorted_), min_x - max_width_, [](const Bounds& b, double x) {
+    return b.min_x < x;
+  });
+}
+
+}
+}
@@ -0,0 +1,75 @@
+#ifndef RAF_GAME_PENDING_PATHS_H_
+#define RAF_GAME_PENDING_PATHS_H_
+
+#include "path.hpp"
+#include "../math/math.hpp"
+
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Paths closer than radius * PATH_CLEARANCE_FACTOR are treated as colliding.
+constexpr double PATH_CLEARANCE_FACTOR = 2.1;
+
+// Paths committed this frame, with a sweep-and-prune broadphase.
+//
+// Each path's swept bounding box, grown by its clearance, is kept sorted by
+// its left edge. A query only visits boxes whose left edge lies between the
+// query's left edge minus the widest box and the query's right edge, so a
+// check against M paths costs O(log M + k) rather than O(M).
+class PendingPaths {
+public:
+  using const_iterator = std::vector<Path>::const_iterator;
+
+  void clear();
+  void push_back(const Path& path);
+  // Drop the paths committed by ship_id, keeping the rest in commit order.
+  void erase(EntityId ship_id);
+
+  size_t size() const { return paths_.size(); }
+  bool empty() const { return paths_.empty(); }
+  // In the order they were committed.
+  const std::vector<Path>& paths() const { return paths_; }
+  const_iterator begin() const { return paths_.begin(); }
+  const_iterator end() const { return paths_.end(); }
+
+  // Call func(const Path&) for each path whose grown bounding box overlaps
+  // the bounding box of start->end, stopping early if func returns true.
+  // Returns true if func did.
+  template<typename Func>
+  bool any_near(const math::Vec2d& start, const math::Vec2d& end, Func func) const {
+    const Bounds query = bounds_of(start, end, 0.0);
+    for (auto it = first_candidate(query.min_x); it != std::end(sorted_) && it->min_x <= query.max_x; ++it) {
+      if (it->max_x < query.min_x || it->max_y < query.min_y || it->min_y > query.max_y) {
+        continue;
+      }
+      if (func(paths_[it->index])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  struct Bounds {
+    double min_x;
+    double max_x;
+    double min_y;
+    double max_y;
+    int index;
+  };
+
+  static Bounds bounds_of(const math::Vec2d& start, const math::Vec2d& end, double margin);
+  std::vector<Bounds>::const_iterator first_candidate(double min_x) const;
+
+  std::vector<Path> paths_;
+  // Sorted by min_x.
+  std::vector<Bounds> sorted_;
+  double max_width_ = 0.0;
+};
+
+}
+}
+
+#endif // !RAF_GAME_PENDING_PATHS_H_
@@ -0,0 +1,103 @@
+#include "pending_paths.hpp"
+#include "path.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+using raf::game::Path;
+using raf::game::PendingPaths;
+using raf::game::PATH_CLEARANCE_FACTOR;
+using raf::math::Vec2d;
+
+static bool collides(const Path& path, const Vec2d& start, const Vec2d& end) {
+  const auto dist_squared = raf::math::min_dist_squared(path.start_pos, path.end_pos - path.start_pos, start, end - start);
+  const auto clearance = path.radius * PATH_CLEARANCE_FACTOR;
+  return dist_squared < clearance * clearance;
+}
+
+static Vec2d random_move(const Vec2d& start, std::mt19937& rng) {
+  std::uniform_real_distribution<double> angle(0, 2 * M_PI);
+  std::uniform_int_distribution<int> thrust(0, 7);
+  const auto a = angle(rng);
+  const auto t = thrust(rng);
+  return { start.x() + t * std::cos(a), start.y() + t * std::sin(a) };
+}
+
+TEST(raf_pending_paths, empty)
+{
+  PendingPaths paths;
+  ASSERT_TRUE(paths.empty());
+  ASSERT_FALSE(paths.any_near({ 0, 0 }, { 7, 0 }, [](const Path&) { return true; }));
+}
+
+TEST(raf_pending_paths, keeps_commit_order)
+{
+  PendingPaths paths;
+  paths.push_back(Path(3, Vec2d(50, 0), Vec2d(57, 0), 0.5));
+  paths.push_back(Path(1, Vec2d(10, 0), Vec2d(17, 0), 0.5));
+  paths.push_back(Path(2, Vec2d(30, 0), Vec2d(37, 0), 0.5));
+
+  ASSERT_EQ(3, paths.size());
+  ASSERT_EQ(3, paths.paths()[0].ship_id);
+  ASSERT_EQ(1, paths.paths()[1].ship_id);
+  ASSERT_EQ(2, paths.paths()[2].ship_id);
+
+  paths.clear();
+  ASSERT_TRUE(paths.empty());
+}
+
+TEST(raf_pending_paths, erase)
+{
+  PendingPaths paths;
+  paths.push_back(Path(3, Vec2d(50, 0), Vec2d(57, 0), 0.5));
+  paths.push_back(Path(1, Vec2d(10, 0), Vec2d(17, 0), 0.5));
+  paths.push_back(Path(2, Vec2d(30, 0), Vec2d(37, 0), 0.5));
+
+  paths.erase(1);
+  ASSERT_EQ(2, paths.size());
+  ASSERT_EQ(3, paths.paths()[0].ship_id);
+  ASSERT_EQ(2, paths.paths()[1].ship_id);
+  ASSERT_FALSE(paths.any_near({ 10, 0 }, { 17, 0 }, [](const Path&) { return true; }));
+  ASSERT_TRUE(paths.any_near({ 30, 0 }, { 37, 0 }, [](const Path&) { return true; }));
+
+  paths.erase(7);
+  ASSERT_EQ(2, paths.size());
+}
+
+TEST(raf_pending_paths, broadphase_matches_linear_scan)
+{
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<double> x(0, 120);
+  std::uniform_real_distribution<double> y(0, 80);
+
+  PendingPaths paths;
+  std::vector<Path> linear;
+  for (int i = 0; i < 150; i++) {
+    const Vec2d start(x(rng), y(rng));
+    const Path path(i, start, random_move(start, rng), 0.5);
+    paths.push_back(path);
+    linear.push_back(path);
+  }
+
+  int hits = 0;
+  for (int i = 0; i < 5000; i++) {
+    const Vec2d start(x(rng), y(rng));
+    const auto end = random_move(start, rng);
+
+    bool expected = false;
+    for (const auto& path : linear) {
+      expected = expected || collides(path, start, end);
+    }
+
+    const bool found = paths.any_near(start, end, [&](const Path& path) {
+      return collides(path, start, end);
+    });
+    ASSERT_EQ(expected, found) << "query " << i;
+    hits += found;
+  }
+  // Make sure the test exercises both outcomes.
+  ASSERT_GT(hits, 0);
+  ASSERT_LT(hits, 5000);
+}
@@ -1,7 +1,5 @@
 #include "planet.hpp"
 
-#include <set>
-
 #include "../../hlt/planet.hpp"
 
 namespace raf {
@@ -10,9 +8,7 @@ namespace game {
 Planet::Planet(const hlt::Planet & planet) :
   Entity(planet),
   num_docking_spots_(planet.docking_spots),
-  docked_ships_(std::set<EntityId>(
-    std::begin(planet.docked_ships),
-    std::end(planet.docked_ships))) {
+  docked_ships_(std::begin(planet.docked_ships), std::end(planet.docked_ships)) {
 }
 
 void Planet::update(const hlt::Planet & planet) {
@@ -20,9 +16,7 @@ void Planet::update(const hlt::Planet & planet) {
   Entity::update(planet);
 
   num_docking_spots_ = planet.docking_spots;
-  docked_ships_ = std::set<EntityId>(
-    std::begin(planet.docked_ships),
-    std::end(planet.docked_ships));
+  docked_ships_.assign(std::begin(planet.docked_ships), std::end(planet.docked_ships));
 }
 
 } // namespace game
@@ -4,14 +4,76 @@
 #include "entity.hpp"
 #include "ship.hpp"
 #include "hlt_fwd.hpp"
+#include "../log.hpp"
 
+#include <algorithm>
+#include <array>
 #include <iomanip>
-#include <set>
 
 namespace raf {
 struct PlanetSnapshot;
 namespace game {
 
+// Most ships a planet can hold. Halite II gives a planet at most 6 spots.
+constexpr size_t MAX_DOCKING_SPOTS = 8;
+
+// Ids of the ships docked at a planet, held inline in ascending order like a
+// std::set. Membership is a linear scan over a handful of ids, and copying
+// or overwriting it never allocates.
+class DockedShipSet {
+public:
+  using const_iterator = const EntityId*;
+
+  DockedShipSet() : size_(0) {}
+
+  template<typename Iterator>
+  DockedShipSet(Iterator first, Iterator last) : size_(0) {
+    assign(first, last);
+  }
+
+  template<typename Iterator>
+  void assign(Iterator first, Iterator last) {
+    size_ = 0;
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  // Whether id was added. A full set keeps the ships it has and drops id,
+  // rather than take the bot down mid-game over a bad snapshot.
+  bool insert(EntityId id) {
+    auto* position = std::lower_bound(ids_.data(), ids_.data() + size_, id);
+    if (position != ids_.data() + size_ && *position == id) {
+      return false;
+    }
+    if (size_ == MAX_DOCKING_SPOTS) {
+      raf::Log("DockedShipSet: more than ", MAX_DOCKING_SPOTS, " ships, dropping ", id);
+      return false;
+    }
+    std::copy_backward(position, ids_.data() + size_, ids_.data() + size_ + 1);
+    *position = id;
+    size_++;
+    return true;
+  }
+
+  bool contains(EntityId id) const {
+    return std::find(cbegin(), cend(), id) != cend();
+  }
+
+  void clear() { size_ = 0; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  const_iterator begin() const { return ids_.data(); }
+  const_iterator end() const { return ids_.data() + size_; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+private:
+  std::array<EntityId, MAX_DOCKING_SPOTS> ids_;
+  size_t size_;
+};
+
 class Planet : public Entity {
 public:
   Planet(EntityId id, EntityId owner_id, const math::Vec2d& initial_location, double radius, int health, int num_docking_spots)
@@ -29,7 +91,7 @@ public:
   size_t free_docking_spots() const { return num_docking_spots_ - docked_ships_.size(); }
 
   bool is_docked(EntityId id) const {
-    return docked_ships_.find(id) != std::end(docked_ships_);
+    return docked_ships_.contains(id);
   }
 
   void dock_ship(EntityId id) {
@@ -39,9 +101,7 @@ public:
 private:
   int num_docking_spots_;
 public:
-  std::set<EntityId> docked_ships_;
-  // Vector for compatbility for now.
-  //std::vector<EntityId> docked_ships_;
+  DockedShipSet docked_ships_;
 };
 
 inline math::Vec2d spawn_point(const game::Planet &planet, int width, int height) {
@@ -51,12 +111,7 @@ inline math::Vec2d spawn_point(const game::Planet &planet, int width, int height
   // target on a vector aiming at the subject.
   const auto target_pos = planet.current_location();
   const math::Vec2d center{ width / 2.0, height / 2.0 };
-  const double angle_rad = target_pos.orient_towards_in_rad(center);
-
-  const double x = target_pos.x() + radius * std::cos(angle_rad);
-  const double y = target_pos.y() + radius * std::sin(angle_rad);
-
-  return { x, y };
+  return math::point_towards(target_pos, center, radius);
 }
 
 
@@ -0,0 +1,145 @@
+#include "planet_distance_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace raf {
+namespace game {
+
+PlanetDistanceField::PlanetDistanceField(const math::Vec2i& dimensions, double cell_size)
+  : cell_size_(cell_size),
+  columns_(std::max(1, static_cast<int>(std::ceil(dimensions.x() / cell_size)))),
+  rows_(std::max(1, static_cast<int>(std::ceil(dimensions.y() / cell_size)))) {
+}
+
+bool PlanetDistanceField::can_mirror(const MapSymmetry* symmetry) const {
+  if (symmetry == nullptr || !symmetry->is_symmetric()
+    || columns_ * cell_size_ != symmetry->dimensions().x()
+    || rows_ * cell_size_ != symmetry->dimensions().y()) {
+    return false;
+  }
+  for (const auto flip : symmetry->flips()) {
+    for (const auto& site : planets_) {
+      if (symmetry->mirror_planet(site.id, flip) == INVALID_ENTITIY_ID) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void PlanetDistanceField::build_cells(const MapSymmetry* symmetry) {
+  // Distance is 1-Lipschitz, so across a cell it changes by at most half a
+  // diagonal either side of the center. A planet can only win somewhere in
+  // the cell if it is within a full diagonal of the best at the center.
+  // Mirrored planets can be SYMMETRY_TOLERANCE out in both location and
+  // radius, so copied cells allow for that on both planets compared.
+  const bool mirror = can_mirror(symmetry);
+  const double diagonal = cell_size_ * std::sqrt(2.0) + (mirror ? 4 * SYMMETRY_TOLERANCE : 0.0);
+
+  // Site index by planet id, for mapping mirrored candidates.
+  std::vector<int> site_of;
+  if (mirror) {
+    for (int i = 0; i < static_cast<int>(planets_.size()); i++) {
+      const auto id = planets_[i].id;
+      if (id >= static_cast<int>(site_of.size())) {
+        site_of.resize(id + 1, -1);
+      }
+      site_of[id] = i;
+    }
+  }
+
+  offsets_.assign(1, 0);
+  candidates_.clear();
+  std::vector<std::pair<double, int>> distances;
+  distances.reserve(planets_.size());
+
+  for (int y = 0; y < rows_; y++) {
+    for (int x = 0; x < columns_; x++) {
+      const math::Vec2d center((x + 0.5) * cell_size_, (y + 0.5) * cell_size_);
+
+      const auto flip = mirror ? symmetry->to_fundamental(center) : Flip::None;
+      if (flip != Flip::None) {
+        // The fundamental region is the low half of each flipped axis, so in
+        // row-major order the image has already been built.
+        const auto bits = static_cast<int>(flip);
+        const int image_x = (bits & static_cast<int>(Flip::X)) ? columns_ - 1 - x : x;
+        const int image_y = (bits & static_cast<int>(Flip::Y)) ? rows_ - 1 - y : y;
+        const int image = image_y * columns_ + image_x;
+        for (int i = offsets_[image]; i < offsets_[image + 1]; i++) {
+          candidates_.push_back(site_of[symmetry->mirror_planet(planets_[candidates_[i]].id, flip)]);
+        }
+        offsets_.push_back(static_cast<int>(candidates_.size()));
+        continue;
+      }
+
+      distances.clear();
+      for (int i = 0; i < static_cast<int>(planets_.size()); i++) {
+        distances.push_back({ surface_distance(planets_[i], center), i });
+      }
+      std::sort(std::begin(distances), std::end(distances));
+
+      for (const auto& d : distances) {
+        if (d.first > distances.front().first + diagonal) {
+          break;
+        }
+        candidates_.push_back(d.second);
+      }
+      offsets_.push_back(static_cast<int>(candidates_.size()));
+    }
+  }
+}
+
+int PlanetDistanceField::cell_index(const math::Vec2d& location) const {
+  const int x = std::min(columns_ - 1, std::max(0, static_cast<int>(std::floor(location.x() / cell_size_))));
+  const int y = std::min(rows_ - 1, std::max(0, static_cast<int>(std::floor(location.y() / cell_size_))));
+  return y * columns_ + x;
+}
+
+NearestPlanet PlanetDistanceField::nearest(const math::Vec2d& location) const {
+  if (planets_.empty()) {
+    return { INVALID_ENTITIY_ID, std::numeric_limits<double>::infinity() };
+  }
+
+  NearestPlanet best = { INVALID_ENTITIY_ID, std::numeric_limits<double>::infinity() };
+  const auto consider = [&](const Site& site) {
+    const auto distance = surface_distance(site, location);
+    if (distance < best.surface_distance || (distance == best.surface_distance && site.id < best.id)) {
+      best = { site.id, distance };
+    }
+  };
+
+  const auto cell = cell_index(location);
+  const bool inside_map = location.x() >= 0 && location.y() >= 0
+    && location.x() < columns_ * cell_size_ && location.y() < rows_ * cell_size_;
+  // The candidate list only rules out other planets while the planet nearest
+  // the cell center is alive.
+  if (inside_map && planets_[candidates_[offsets_[cell]]].alive) {
+    for (int i = offsets_[cell]; i < offsets_[cell + 1]; i++) {
+      const auto& site = planets_[candidates_[i]];
+      if (site.alive) {
+        consider(site);
+      }
+    }
+    return best;
+  }
+
+  // Off the map, or the planet nearest this cell has been destroyed.
+  for (const auto& site : planets_) {
+    if (site.alive) {
+      consider(site);
+    }
+  }
+  return best;
+}
+
+EntityId PlanetDistanceField::cell_nearest_id(const math::Vec2d& location) const {
+  if (planets_.empty()) {
+    return INVALID_ENTITIY_ID;
+  }
+  return planets_[candidates_[offsets_[cell_index(location)]]].id;
+}
+
+}
+}
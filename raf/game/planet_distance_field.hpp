@@ -0,0 +1,127 @@
+#ifndef RAF_GAME_PLANET_DISTANCE_FIELD_H_
+#define RAF_GAME_PLANET_DISTANCE_FIELD_H_
+
+#include "entity.hpp"
+#include "map_symmetry.hpp"
+#include "planet.hpp"
+#include "../math/math.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Two units keeps the largest map (384x256) at 192x128 cells.
+constexpr double DEFAULT_PLANET_FIELD_CELL_SIZE = 2.0;
+
+// Nearest planet to a point and the signed distance to its surface.
+// Negative distances are inside the planet.
+struct NearestPlanet {
+  EntityId id;
+  double surface_distance;
+};
+
+// Voronoi grid of planet surfaces, built once at the start of the game.
+//
+// Every cell stores the planets that could be nearest to some point inside
+// it: the planet nearest the cell center plus any planet whose surface is
+// within a cell diagonal of that. A query is a table lookup followed by an
+// exact check of those few candidates, so it gives the same answer as a scan
+// of every planet.
+//
+// On a symmetric map only the fundamental region is computed, every other
+// cell copies its mirror image's candidates.
+//
+// Destroyed planets are dropped by refresh(). Cells whose nearest planet has
+// been destroyed fall back to a scan of the live planets.
+class PlanetDistanceField {
+public:
+  PlanetDistanceField(const math::Vec2i& dimensions, double cell_size = DEFAULT_PLANET_FIELD_CELL_SIZE);
+
+  // Build the field. Call once with the planets of the initial map.
+  template<typename Container>
+  void build(const Container& planets) {
+    collect(planets);
+    build_cells(nullptr);
+  }
+
+  // As build(), mirroring the cells outside symmetry's fundamental region.
+  // symmetry must have been detected from the same planets.
+  template<typename Container>
+  void build(const Container& planets, const MapSymmetry& symmetry) {
+    collect(planets);
+    build_cells(&symmetry);
+  }
+
+  // Mark planets missing from the container as destroyed.
+  template<typename Container>
+  void refresh(const Container& planets) {
+    for (auto& p : planets_) {
+      p.alive = false;
+    }
+    for (const auto& e : planets) {
+      const auto& planet = planet_of(e);
+      for (auto& p : planets_) {
+        if (p.id == planet.id()) {
+          p.alive = true;
+          break;
+        }
+      }
+    }
+  }
+
+  bool is_built() const { return !planets_.empty(); }
+
+  // Nearest live planet surface to location.
+  // Returns { INVALID_ENTITIY_ID, infinity } when every planet is destroyed.
+  NearestPlanet nearest(const math::Vec2d& location) const;
+
+  // Nearest planet according to the cell center alone, with no refinement.
+  // May be wrong near the boundary between two planets, and ignores
+  // destroyed planets.
+  EntityId cell_nearest_id(const math::Vec2d& location) const;
+
+private:
+  struct Site {
+    EntityId id;
+    math::Vec2d location;
+    double radius;
+    bool alive;
+  };
+
+  static const Planet& planet_of(const Planet& planet) { return planet; }
+  static const Planet& planet_of(const std::pair<const EntityId, Planet>& e) { return e.second; }
+
+  template<typename Container>
+  void collect(const Container& planets) {
+    planets_.clear();
+    for (const auto& e : planets) {
+      const auto& planet = planet_of(e);
+      planets_.push_back({ planet.id(), planet.current_location(), planet.radius(), true });
+    }
+  }
+
+  void build_cells(const MapSymmetry* symmetry);
+  // Whether cells mirror onto cells under symmetry's flips.
+  bool can_mirror(const MapSymmetry* symmetry) const;
+  int cell_index(const math::Vec2d& location) const;
+  double surface_distance(const Site& site, const math::Vec2d& location) const {
+    return (site.location - location).length() - site.radius;
+  }
+
+  double cell_size_;
+  int columns_;
+  int rows_;
+  std::vector<Site> planets_;
+  // Candidates for cell i are candidates_[offsets_[i]] to
+  // candidates_[offsets_[i + 1]], nearest to the cell center first.
+  std::vector<int> offsets_;
+  std::vector<int> candidates_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_PLANET_DISTANCE_FIELD_H_
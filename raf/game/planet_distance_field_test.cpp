@@ -0,0 +1,208 @@
+#include "planet_distance_field.hpp"
+#include "map_symmetry.hpp"
+#include "planet.hpp"
+#include "ship.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <vector>
+
+using raf::game::EntityId;
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::MapSymmetry;
+using raf::game::NearestPlanet;
+using raf::game::Planet;
+using raf::game::PlanetDistanceField;
+using raf::game::Ship;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+
+static NearestPlanet linear_nearest(const std::map<EntityId, Planet>& planets, const Vec2d& location) {
+  NearestPlanet best = { INVALID_ENTITIY_ID, std::numeric_limits<double>::infinity() };
+  for (const auto& e : planets) {
+    const auto distance = (e.second.current_location() - location).length() - e.second.radius();
+    if (distance < best.surface_distance) {
+      best = { e.first, distance };
+    }
+  }
+  return best;
+}
+
+static std::map<EntityId, Planet> random_planets(const Vec2i& dimensions, int count, std::mt19937& rng) {
+  std::uniform_real_distribution<double> x(10, dimensions.x() - 10);
+  std::uniform_real_distribution<double> y(10, dimensions.y() - 10);
+  std::uniform_real_distribution<double> radius(3, 9);
+  std::map<EntityId, Planet> planets;
+  for (EntityId id = 0; id < count; id++) {
+    planets.emplace(id, Planet(id, INVALID_ENTITIY_ID, { x(rng), y(rng) }, radius(rng), 1000, 3));
+  }
+  return planets;
+}
+
+TEST(raf_planet_distance_field, empty)
+{
+  PlanetDistanceField field(Vec2i(240, 160));
+  field.build(std::vector<Planet>());
+  ASSERT_FALSE(field.is_built());
+  ASSERT_EQ(INVALID_ENTITIY_ID, field.nearest({ 10, 10 }).id);
+}
+
+TEST(raf_planet_distance_field, matches_linear_scan)
+{
+  std::mt19937 rng(7);
+  // Smallest and largest map sizes.
+  for (const auto& dimensions : { Vec2i(240, 160), Vec2i(384, 256) }) {
+    const auto planets = random_planets(dimensions, 24, rng);
+    PlanetDistanceField field(dimensions);
+    field.build(planets);
+
+    std::uniform_real_distribution<double> x(-5, dimensions.x() + 5);
+    std::uniform_real_distribution<double> y(-5, dimensions.y() + 5);
+    for (int i = 0; i < 20000; i++) {
+      const Vec2d location(x(rng), y(rng));
+      const auto expected = linear_nearest(planets, location);
+      const auto actual = field.nearest(location);
+      ASSERT_EQ(expected.id, actual.id) << location;
+      ASSERT_DOUBLE_EQ(expected.surface_distance, actual.surface_distance);
+    }
+  }
+}
+
+TEST(raf_planet_distance_field, inside_planet_is_negative)
+{
+  const std::vector<Planet> planets = { Planet(4, INVALID_ENTITIY_ID, { 50, 50 }, 6, 1000, 3) };
+  PlanetDistanceField field(Vec2i(240, 160));
+  field.build(planets);
+
+  const auto nearest = field.nearest({ 52, 50 });
+  ASSERT_EQ(4, nearest.id);
+  ASSERT_DOUBLE_EQ(-4.0, nearest.surface_distance);
+  ASSERT_EQ(4, field.cell_nearest_id({ 52, 50 }));
+}
+
+TEST(raf_planet_distance_field, refresh_skips_destroyed_planets)
+{
+  std::mt19937 rng(11);
+  const Vec2i dimensions(288, 192);
+  auto planets = random_planets(dimensions, 20, rng);
+  PlanetDistanceField field(dimensions);
+  field.build(planets);
+
+  for (EntityId id = 0; id < 20; id += 3) {
+    planets.erase(id);
+  }
+  field.refresh(planets);
+
+  std::uniform_real_distribution<double> x(0, dimensions.x());
+  std::uniform_real_distribution<double> y(0, dimensions.y());
+  for (int i = 0; i < 20000; i++) {
+    const Vec2d location(x(rng), y(rng));
+    ASSERT_EQ(linear_nearest(planets, location).id, field.nearest(location).id) << location;
+  }
+
+  field.refresh(std::vector<Planet>());
+  ASSERT_EQ(INVALID_ENTITIY_ID, field.nearest({ 10, 10 }).id);
+}
+
+// Planets in the bottom left quadrant mirrored into the other three, each
+// nudged by up to a quarter of the tolerance as if rounded.
+static std::map<EntityId, Planet> quadrant_planets(const Vec2i& dimensions, int count, std::mt19937& rng) {
+  std::uniform_real_distribution<double> x(10, dimensions.x() / 2 - 10);
+  std::uniform_real_distribution<double> y(10, dimensions.y() / 2 - 10);
+  std::uniform_real_distribution<double> radius(3, 9);
+  std::uniform_real_distribution<double> nudge(-0.25 * raf::game::SYMMETRY_TOLERANCE, 0.25 * raf::game::SYMMETRY_TOLERANCE);
+  std::map<EntityId, Planet> planets;
+  EntityId id = 0;
+  for (int i = 0; i < count; i++) {
+    const Vec2d location(x(rng), y(rng));
+    const double r = radius(rng);
+    for (const auto& flipped : {
+      location,
+      Vec2d(dimensions.x() - location.x(), location.y()),
+      Vec2d(location.x(), dimensions.y() - location.y()),
+      Vec2d(dimensions.x() - location.x(), dimensions.y() - location.y()) }) {
+      planets.emplace(id, Planet(id, INVALID_ENTITIY_ID, flipped + Vec2d(nudge(rng), nudge(rng)), r, 1000, 3));
+      id++;
+    }
+  }
+  return planets;
+}
+
+static std::vector<Ship> quadrant_spawns(const Vec2i& dimensions) {
+  const double x = 20;
+  const double y = 20;
+  return {
+    Ship(0, 0, { x, y }, 0.5, 255),
+    Ship(1, 1, { dimensions.x() - x, y }, 0.5, 255),
+    Ship(2, 2, { x, dimensions.y() - y }, 0.5, 255),
+    Ship(3, 3, { dimensions.x() - x, dimensions.y() - y }, 0.5, 255),
+  };
+}
+
+TEST(raf_planet_distance_field, mirrored_matches_linear_scan)
+{
+  std::mt19937 rng(13);
+  for (const auto& dimensions : { Vec2i(240, 160), Vec2i(384, 256), Vec2i(250, 170) }) {
+    auto planets = quadrant_planets(dimensions, 6, rng);
+    MapSymmetry symmetry(dimensions);
+    symmetry.detect(planets, quadrant_spawns(dimensions));
+    ASSERT_EQ(4u, symmetry.flips().size());
+    PlanetDistanceField field(dimensions);
+    field.build(planets, symmetry);
+
+    std::uniform_real_distribution<double> x(-5, dimensions.x() + 5);
+    std::uniform_real_distribution<double> y(-5, dimensions.y() + 5);
+    for (int i = 0; i < 20000; i++) {
+      const Vec2d location(x(rng), y(rng));
+      const auto expected = linear_nearest(planets, location);
+      const auto actual = field.nearest(location);
+      ASSERT_EQ(expected.id, actual.id) << location;
+      ASSERT_DOUBLE_EQ(expected.surface_distance, actual.surface_distance);
+    }
+
+    for (EntityId id = 0; id < 24; id += 5) {
+      planets.erase(id);
+    }
+    field.refresh(planets);
+    for (int i = 0; i < 20000; i++) {
+      const Vec2d location(x(rng), y(rng));
+      ASSERT_EQ(linear_nearest(planets, location).id, field.nearest(location).id) << location;
+    }
+  }
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(raf_planet_distance_field, DISABLED_benchmark_mirrored_build)
+{
+  using Clock = std::chrono::steady_clock;
+  std::mt19937 rng(1);
+  const Vec2i dimensions(384, 256);
+  const auto planets = quadrant_planets(dimensions, 7, rng);
+  MapSymmetry symmetry(dimensions);
+  symmetry.detect(planets, quadrant_spawns(dimensions));
+  const int rounds = 20;
+
+  PlanetDistanceField field(dimensions);
+  auto start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    field.build(planets);
+  }
+  const auto full_time = Clock::now() - start;
+
+  start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    field.build(planets, symmetry);
+  }
+  const auto mirrored_time = Clock::now() - start;
+
+  const auto per_build = [rounds](Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count() / rounds;
+  };
+  std::cout << planets.size() << " planets: full " << per_build(full_time)
+    << "ms, mirrored " << per_build(mirrored_time) << "ms" << std::endl;
+}
@@ -0,0 +1,164 @@
+#include "planet_index.hpp"
+#include "collision.hpp"
+
+#include "../stdlib_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace raf {
+namespace game {
+
+// Planets are registered with cells a little beyond their navigation radius.
+// The extra unit means a segment that only grazes a planet still walks
+// through a cell the planet is registered with, even with rounding at cell
+// boundaries.
+static constexpr double REGISTRATION_MARGIN = constants::FORECAST_FUDGE_FACTOR + 1.0;
+
+PlanetIndex::PlanetIndex(const math::Vec2i& dimensions, double cell_size)
+  : cell_size_(cell_size),
+  columns_(std::max(1, static_cast<int>(std::ceil(dimensions.x() / cell_size)))),
+  rows_(std::max(1, static_cast<int>(std::ceil(dimensions.y() / cell_size)))),
+  cells_(columns_ * rows_) {
+}
+
+void PlanetIndex::clear() {
+  entries_.clear();
+  for (auto& cell : cells_) {
+    cell.clear();
+  }
+}
+
+void PlanetIndex::add(const Planet& planet) {
+  entries_.push_back({ planet.id(), planet.current_location(), planet.radius(), nullptr });
+}
+
+void PlanetIndex::bucket() {
+  std::sort(std::begin(entries_), std::end(entries_), [](const Entry& a, const Entry& b) {
+    return a.id < b.id;
+  });
+
+  for (Slot slot = 0; slot < static_cast<Slot>(entries_.size()); slot++) {
+    const auto& entry = entries_[slot];
+    const auto extent = entry.radius + REGISTRATION_MARGIN;
+    for (int y = row(entry.location.y() - extent); y <= row(entry.location.y() + extent); y++) {
+      for (int x = column(entry.location.x() - extent); x <= column(entry.location.x() + extent); x++) {
+        cells_[y * columns_ + x].push_back(slot);
+      }
+    }
+  }
+}
+
+PlanetIndex::Slot PlanetIndex::slot_of(EntityId id) const {
+  const auto it = std::lower_bound(std::begin(entries_), std::end(entries_), id, [](const Entry& a, EntityId id) {
+    return a.id < id;
+  });
+  if (it == std::end(entries_) || it->id != id) {
+    return INVALID_SLOT;
+  }
+  return static_cast<Slot>(it - std::begin(entries_));
+}
+
+int PlanetIndex::column(double x) const {
+  return std::min(columns_ - 1, std::max(0, static_cast<int>(std::floor(x / cell_size_))));
+}
+
+int PlanetIndex::row(double y) const {
+  return std::min(rows_ - 1, std::max(0, static_cast<int>(std::floor(y / cell_size_))));
+}
+
+void PlanetIndex::prune_candidates(FrameVector<Slot>& candidates) const {
+  std::sort(std::begin(candidates), std::end(candidates));
+  candidates.erase(std::unique(std::begin(candidates), std::end(candidates)), std::end(candidates));
+  candidates.erase(
+    std::remove_if(std::begin(candidates), std::end(candidates), [this](Slot slot) {
+      return entries_[slot].planet == nullptr;
+    }),
+    std::end(candidates));
+}
+
+FrameVector<PlanetIndex::Slot> PlanetIndex::slots_on_segment(
+  const math::Vec2d& start,
+  const math::Vec2d& end,
+  double fudge) const {
+  FrameVector<Slot> candidates;
+
+  if (fudge > constants::FORECAST_FUDGE_FACTOR) {
+    // Cells were not inflated enough to guarantee a hit, test everything.
+    for (Slot slot = 0; slot < static_cast<Slot>(entries_.size()); slot++) {
+      candidates.push_back(slot);
+    }
+  } else {
+    // Walk the cells the segment passes through (Amanatides & Woo).
+    const auto delta = end - start;
+    int x = column(start.x());
+    int y = row(start.y());
+    const int end_x = column(end.x());
+    const int end_y = row(end.y());
+    const int step_x = delta.x() > 0 ? 1 : -1;
+    const int step_y = delta.y() > 0 ? 1 : -1;
+
+    const auto infinity = std::numeric_limits<double>::infinity();
+    double t_max_x = infinity, t_delta_x = infinity;
+    double t_max_y = infinity, t_delta_y = infinity;
+    if (delta.x() != 0) {
+      const double boundary = (x + (step_x > 0 ? 1 : 0)) * cell_size_;
+      t_max_x = (boundary - start.x()) / delta.x();
+      t_delta_x = cell_size_ / std::fabs(delta.x());
+    }
+    if (delta.y() != 0) {
+      const double boundary = (y + (step_y > 0 ? 1 : 0)) * cell_size_;
+      t_max_y = (boundary - start.y()) / delta.y();
+      t_delta_y = cell_size_ / std::fabs(delta.y());
+    }
+
+    // Never walk more cells than a full diagonal, guards against clamped
+    // off map end points.
+    for (int steps = 0; steps <= columns_ + rows_; steps++) {
+      const auto& cell = cells_[y * columns_ + x];
+      candidates.insert(std::end(candidates), std::begin(cell), std::end(cell));
+
+      if (x == end_x && y == end_y) {
+        break;
+      }
+
+      if (t_max_x < t_max_y) {
+        x = std::min(columns_ - 1, std::max(0, x + step_x));
+        t_max_x += t_delta_x;
+      } else {
+        y = std::min(rows_ - 1, std::max(0, y + step_y));
+        t_max_y += t_delta_y;
+      }
+    }
+  }
+
+  prune_candidates(candidates);
+
+  filter(candidates, [&](Slot slot) {
+    const auto& entry = entries_[slot];
+    return !collision::segment_circle_intersect(start, end, entry.location, fudge, entry.radius);
+  });
+  return candidates;
+}
+
+FrameVector<PlanetIndex::Slot> PlanetIndex::slots_in_range(const math::Vec2d& location, double range) const {
+  FrameVector<Slot> candidates;
+  for (int y = row(location.y() - range); y <= row(location.y() + range); y++) {
+    for (int x = column(location.x() - range); x <= column(location.x() + range); x++) {
+      const auto& cell = cells_[y * columns_ + x];
+      candidates.insert(std::end(candidates), std::begin(cell), std::end(cell));
+    }
+  }
+
+  prune_candidates(candidates);
+
+  filter(candidates, [&](Slot slot) {
+    const auto& entry = entries_[slot];
+    return (entry.location - location).length() - entry.radius >= range;
+  });
+  return candidates;
+}
+
+} // namespace game
+} // namespace raf
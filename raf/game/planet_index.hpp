@@ -0,0 +1,133 @@
+#ifndef RAF_GAME_PLANET_INDEX_H_
+#define RAF_GAME_PLANET_INDEX_H_
+
+#include "constants.hpp"
+#include "entity.hpp"
+#include "frame_arena.hpp"
+#include "planet.hpp"
+#include "../math/math.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Planets are bigger than ships, so use coarser cells than the ship grid.
+constexpr double DEFAULT_PLANET_INDEX_CELL_SIZE = 16.0;
+
+// Static acceleration structure for planets.
+//
+// Planets never move, so their geometry is bucketed once at the start of the
+// game. Each planet is registered in every cell its inflated bounding box
+// touches, which means a segment or radius query only has to look in the
+// cells it passes through.
+//
+// Planet state that can change (owner, health, docked ships or destruction)
+// is read through a pointer to the live Planet which refresh() re-targets
+// each frame.
+class PlanetIndex {
+public:
+  PlanetIndex(const math::Vec2i& dimensions, double cell_size = DEFAULT_PLANET_INDEX_CELL_SIZE);
+
+  // Bucket planet geometry. Call once with the planets of the initial map.
+  template<typename Container>
+  void build(const Container& planets) {
+    clear();
+    for (const auto& e : planets) {
+      add(planet_of(e));
+    }
+    bucket();
+    refresh(planets);
+  }
+
+  // Point the index at the current frame's planets.
+  // Planets missing from the container have been destroyed and are skipped by
+  // all further queries.
+  template<typename Container>
+  void refresh(const Container& planets) {
+    for (auto& entry : entries_) {
+      entry.planet = nullptr;
+    }
+    for (const auto& e : planets) {
+      const auto& planet = planet_of(e);
+      auto slot = slot_of(planet.id());
+      if (slot != INVALID_SLOT) {
+        entries_[slot].planet = &planet;
+      }
+    }
+  }
+
+  bool is_built() const { return !entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+  // Call func(const Planet&) for every live planet that the segment
+  // start->end passes within fudge of, in planet id order.
+  // Uses the same intersection test as navigation::objects_between.
+  template<typename Func>
+  void for_each_on_segment(const math::Vec2d& start, const math::Vec2d& end, double fudge, Func func) const {
+    for (auto slot : slots_on_segment(start, end, fudge)) {
+      func(*entries_[slot].planet);
+    }
+  }
+
+  // Call func(const Planet&) for every live planet whose edge is within range
+  // of location, in planet id order.
+  template<typename Func>
+  void for_each_in_range(const math::Vec2d& location, double range, Func func) const {
+    for (auto slot : slots_in_range(location, range)) {
+      func(*entries_[slot].planet);
+    }
+  }
+
+  std::vector<Planet> in_range(const math::Vec2d& location, double range) const {
+    std::vector<Planet> found;
+    for_each_in_range(location, range, [&found](const Planet& planet) {
+      found.push_back(planet);
+    });
+    return found;
+  }
+
+private:
+  using Slot = int;
+  static constexpr Slot INVALID_SLOT = -1;
+
+  struct Entry {
+    EntityId id;
+    math::Vec2d location;
+    double radius;
+    const Planet* planet;
+  };
+
+  static const Planet& planet_of(const Planet& planet) { return planet; }
+  static const Planet& planet_of(const std::pair<const EntityId, Planet>& e) { return e.second; }
+
+  void clear();
+  void add(const Planet& planet);
+  // Sort entries and register them with every cell they overlap.
+  void bucket();
+  Slot slot_of(EntityId id) const;
+
+  int column(double x) const;
+  int row(double y) const;
+
+  // Navigation asks for every heading it tries, so the candidate lists live
+  // in the frame arena rather than on the heap.
+  FrameVector<Slot> slots_on_segment(const math::Vec2d& start, const math::Vec2d& end, double fudge) const;
+  FrameVector<Slot> slots_in_range(const math::Vec2d& location, double range) const;
+  // Sort, de-duplicate and drop destroyed planets from a candidate list.
+  void prune_candidates(FrameVector<Slot>& candidates) const;
+
+  double cell_size_;
+  int columns_;
+  int rows_;
+  // Sorted by EntityId.
+  std::vector<Entry> entries_;
+  std::vector<std::vector<Slot>> cells_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_PLANET_INDEX_H_
@@ -0,0 +1,147 @@
+#include "planet_index.hpp"
+#include "collision.hpp"
+#include "frame_arena.hpp"
+#include "planet.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+using raf::game::EntityId;
+using raf::game::frame_arena;
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::Planet;
+using raf::game::PlanetIndex;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+
+static std::vector<Planet> make_planets() {
+  return {
+    Planet(0, INVALID_ENTITIY_ID, { 30, 30 }, 5, 1275, 2),
+    Planet(1, INVALID_ENTITIY_ID, { 120, 80 }, 12, 3060, 4),
+    Planet(2, INVALID_ENTITIY_ID, { 200, 40 }, 3.5, 892, 2),
+    Planet(3, INVALID_ENTITIY_ID, { 63.9, 95.8 }, 8, 2040, 3),
+    Planet(4, INVALID_ENTITIY_ID, { 225, 140 }, 6, 1530, 2),
+  };
+}
+
+static std::vector<EntityId> linear_on_segment(const std::vector<Planet>& planets, const Vec2d& start, const Vec2d& end) {
+  std::vector<EntityId> found;
+  for (const auto& planet : planets) {
+    if (raf::collision::segment_circle_intersect(
+      start, end, planet.current_location(), raf::constants::FORECAST_FUDGE_FACTOR, planet.radius())) {
+      found.push_back(planet.id());
+    }
+  }
+  return found;
+}
+
+TEST(raf_planet_index, segment_matches_linear_scan)
+{
+  const auto planets = make_planets();
+  PlanetIndex index(Vec2i(240, 160));
+  index.build(planets);
+  ASSERT_EQ(planets.size(), index.size());
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> x(-5.0, 245.0);
+  std::uniform_real_distribution<double> y(-5.0, 165.0);
+  for (int i = 0; i < 5000; i++) {
+    const Vec2d start{ x(rng), y(rng) };
+    // Mix of short single turn moves and long navigation targets.
+    const Vec2d end = (i % 2) ? Vec2d{ x(rng), y(rng) } : start + Vec2d{ (x(rng) - 120) / 17, (y(rng) - 80) / 11 };
+
+    std::vector<EntityId> found;
+    index.for_each_on_segment(start, end, raf::constants::FORECAST_FUDGE_FACTOR, [&found](const Planet& planet) {
+      found.push_back(planet.id());
+    });
+    ASSERT_EQ(linear_on_segment(planets, start, end), found);
+  }
+}
+
+TEST(raf_planet_index, in_range_matches_linear_scan)
+{
+  const auto planets = make_planets();
+  PlanetIndex index(Vec2i(240, 160));
+  index.build(planets);
+
+  const Vec2d origins[] = { { 0, 0 }, { 100, 60 }, { 239, 159 }, { 64, 80 } };
+  const double ranges[] = { 1.0, 10.0, 28.0, 70.0 };
+  for (const auto& origin : origins) {
+    for (const auto range : ranges) {
+      std::vector<EntityId> expected;
+      for (const auto& planet : planets) {
+        if ((planet.current_location() - origin).length() - planet.radius() < range) {
+          expected.push_back(planet.id());
+        }
+      }
+
+      std::vector<EntityId> found;
+      for (const auto& planet : index.in_range(origin, range)) {
+        found.push_back(planet.id());
+      }
+      ASSERT_EQ(expected, found);
+    }
+  }
+}
+
+TEST(raf_planet_index, refresh_skips_destroyed_planets)
+{
+  std::map<EntityId, Planet> planets;
+  for (const auto& planet : make_planets()) {
+    planets.insert({ planet.id(), planet });
+  }
+
+  PlanetIndex index(Vec2i(240, 160));
+  index.build(planets);
+  ASSERT_EQ(1, index.in_range({ 120, 80 }, 1).size());
+
+  planets.erase(1);
+  index.refresh(planets);
+  ASSERT_TRUE(index.in_range({ 120, 80 }, 1).empty());
+
+  int hits = 0;
+  index.for_each_on_segment({ 100, 80 }, { 140, 80 }, raf::constants::FORECAST_FUDGE_FACTOR, [&hits](const Planet&) {
+    hits++;
+  });
+  ASSERT_EQ(0, hits);
+}
+
+TEST(raf_planet_index, refresh_tracks_ownership)
+{
+  std::map<EntityId, Planet> planets;
+  for (const auto& planet : make_planets()) {
+    planets.insert({ planet.id(), planet });
+  }
+
+  PlanetIndex index(Vec2i(240, 160));
+  index.build(planets);
+
+  planets.at(0).dock_ship(7);
+  const auto found = index.in_range({ 30, 30 }, 1);
+  ASSERT_EQ(1, found.size());
+  ASSERT_TRUE(found.front().is_docked(7));
+}
+
+TEST(raf_planet_index, queries_use_frame_arena)
+{
+  const auto planets = make_planets();
+  PlanetIndex index(Vec2i(240, 160));
+  index.build(planets);
+
+  auto& arena = frame_arena();
+  arena.reset();
+  index.for_each_on_segment({ 0, 0 }, { 240, 160 }, raf::constants::FORECAST_FUDGE_FACTOR, [](const Planet&) {});
+  index.for_each_in_range({ 120, 80 }, 70, [](const Planet&) {});
+  const auto blocks = arena.block_allocations();
+
+  // Candidates come from the arena, and a second frame of the same queries
+  // fits in the space the first one settled on.
+  ASSERT_LT(0u, arena.bytes_allocated());
+  arena.reset();
+  index.for_each_on_segment({ 0, 0 }, { 240, 160 }, raf::constants::FORECAST_FUDGE_FACTOR, [](const Planet&) {});
+  index.for_each_in_range({ 120, 80 }, 70, [](const Planet&) {});
+  ASSERT_EQ(blocks, arena.block_allocations());
+}
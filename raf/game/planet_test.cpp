@@ -5,8 +5,11 @@
 #include "gtest/gtest.h"
 
 #include <algorithm>
+#include <vector>
 
+using raf::game::DockedShipSet;
 using raf::game::INVALID_ENTITIY_ID;
+using raf::game::MAX_DOCKING_SPOTS;
 using raf::game::Planet;
 using raf::game::Ship;
 using raf::math::Vec2d;
@@ -93,3 +96,65 @@ TEST(raf_planet, attacks_to_destroy)
 
 
 
+
+TEST(raf_planet, docked_ships)
+{
+  Vec2d location{ 3, 3 };
+  auto planet = Planet(0, 0, location, 6.0, planet_health_from_radius(6.0), 2);
+
+  planet.dock_ship(9);
+  planet.dock_ship(4);
+  planet.dock_ship(9);
+  ASSERT_EQ(2, planet.used_docking_spots());
+  ASSERT_EQ(0, planet.free_docking_spots());
+  ASSERT_TRUE(planet.is_full());
+  ASSERT_TRUE(planet.is_docked(4));
+  ASSERT_TRUE(planet.is_docked(9));
+  ASSERT_FALSE(planet.is_docked(5));
+  ASSERT_FALSE(is_dockable(planet, 0));
+  // Ordered as a std::set would be.
+  ASSERT_EQ(4, *planet.docked_ships_.cbegin());
+}
+
+TEST(raf_planet, docked_ship_set)
+{
+  const std::vector<int> ids = { 7, 3, 5, 3, 1 };
+  DockedShipSet docked(std::begin(ids), std::end(ids));
+  ASSERT_EQ(4u, docked.size());
+  ASSERT_EQ(std::vector<int>({ 1, 3, 5, 7 }), std::vector<int>(docked.begin(), docked.end()));
+
+  docked.assign(std::begin(ids), std::begin(ids) + 2);
+  ASSERT_EQ(std::vector<int>({ 3, 7 }), std::vector<int>(docked.begin(), docked.end()));
+  ASSERT_FALSE(docked.contains(5));
+
+  docked.clear();
+  ASSERT_TRUE(docked.empty());
+  for (int id = 0; id < static_cast<int>(MAX_DOCKING_SPOTS); id++) {
+    ASSERT_TRUE(docked.insert(id));
+  }
+  ASSERT_FALSE(docked.insert(0));
+}
+
+TEST(raf_planet, docked_ship_set_overflow)
+{
+  DockedShipSet docked;
+  for (int id = 0; id < static_cast<int>(MAX_DOCKING_SPOTS); id++) {
+    ASSERT_TRUE(docked.insert(id * 2));
+  }
+  // Full, so the extra ship is dropped whatever its place in the order.
+  ASSERT_FALSE(docked.insert(100));
+  ASSERT_FALSE(docked.insert(-1));
+  ASSERT_FALSE(docked.insert(3));
+  ASSERT_EQ(MAX_DOCKING_SPOTS, docked.size());
+  ASSERT_FALSE(docked.contains(100));
+  ASSERT_FALSE(docked.contains(3));
+
+  // A snapshot with too many ships keeps the first that fit.
+  std::vector<int> ids;
+  for (int id = 20; id > 20 - static_cast<int>(MAX_DOCKING_SPOTS) - 2; id--) {
+    ids.push_back(id);
+  }
+  docked.assign(std::begin(ids), std::end(ids));
+  ASSERT_EQ(MAX_DOCKING_SPOTS, docked.size());
+  ASSERT_EQ(std::vector<int>({ 13, 14, 15, 16, 17, 18, 19, 20 }), std::vector<int>(docked.begin(), docked.end()));
+}
@@ -0,0 +1,126 @@
+#include "planet_travel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace raf {
+namespace game {
+
+PlanetTravelTable::PlanetTravelTable(const math::Vec2i& dimensions)
+  : dimensions_(dimensions),
+  ids_(0) {
+}
+
+void PlanetTravelTable::build_tables(const PlanetIndex& index) {
+  const auto infinity = std::numeric_limits<double>::infinity();
+  ids_ = 0;
+  for (const auto& site : sites_) {
+    ids_ = std::max(ids_, site.id + 1);
+  }
+  const size_t size = static_cast<size_t>(ids_) * ids_;
+  edge_distance_.assign(size, infinity);
+  travel_distance_.assign(size, infinity);
+  spawn_distance_.assign(size, infinity);
+
+  const auto routes = route_distances(index);
+  const auto count = sites_.size();
+  for (size_t i = 0; i < count; i++) {
+    const auto& from = sites_[i];
+    for (size_t j = 0; j < count; j++) {
+      const auto& to = sites_[j];
+      // The same expressions as the Entity methods, so lookups match them.
+      const double edge = (from.location - to.location).length() - to.radius - from.radius;
+      edge_distance_[cell(from.id, to.id)] = edge;
+      spawn_distance_[cell(from.id, to.id)] = (to.location - from.spawn).length();
+
+      if (i == j) {
+        travel_distance_[cell(from.id, to.id)] = edge;
+        continue;
+      }
+
+      // Straight across unless another planet is in the way.
+      const auto start = math::point_towards(from.location, to.location, from.radius + constants::FORECAST_FUDGE_FACTOR);
+      const auto end = math::point_towards(to.location, from.location, to.radius + constants::FORECAST_FUDGE_FACTOR);
+      bool blocked = false;
+      index.for_each_on_segment(start, end, constants::FORECAST_FUDGE_FACTOR, [&](const Planet& planet) {
+        blocked = blocked || (planet.id() != from.id && planet.id() != to.id);
+      });
+      travel_distance_[cell(from.id, to.id)] = blocked ? std::max(edge, routes[i * count + j]) : edge;
+    }
+  }
+}
+
+std::vector<double> PlanetTravelTable::route_distances(const PlanetIndex& index) const {
+  const auto infinity = std::numeric_limits<double>::infinity();
+  const auto count = sites_.size();
+
+  struct Waypoint {
+    size_t site;
+    math::Vec2d location;
+    // From the planet's surface.
+    double offset;
+  };
+  std::vector<Waypoint> waypoints;
+  const double half_step = M_PI / PLANET_TRAVEL_WAYPOINTS;
+  for (size_t i = 0; i < count; i++) {
+    const auto& site = sites_[i];
+    // Far enough out that the sides of the polygon they make clear the
+    // planet's collision zone.
+    const double radius = (site.radius + constants::FORECAST_FUDGE_FACTOR) / std::cos(half_step) + PLANET_TRAVEL_WAYPOINT_MARGIN;
+    for (int k = 0; k < PLANET_TRAVEL_WAYPOINTS; k++) {
+      const double angle = 2 * half_step * k;
+      waypoints.push_back({ i, site.location + radius * math::Vec2d(std::cos(angle), std::sin(angle)), radius - site.radius });
+    }
+  }
+
+  // Visibility graph, infinity where a planet is in the way.
+  const auto nodes = waypoints.size();
+  std::vector<double> edges(nodes * nodes, infinity);
+  for (size_t u = 0; u < nodes; u++) {
+    for (size_t v = u + 1; v < nodes; v++) {
+      bool blocked = false;
+      index.for_each_on_segment(waypoints[u].location, waypoints[v].location, constants::FORECAST_FUDGE_FACTOR, [&blocked](const Planet&) {
+        blocked = true;
+      });
+      if (!blocked) {
+        edges[u * nodes + v] = edges[v * nodes + u] = (waypoints[u].location - waypoints[v].location).length();
+      }
+    }
+  }
+
+  // Dense Dijkstra from each planet's waypoints at once.
+  std::vector<double> routes(count * count, infinity);
+  std::vector<double> distance(nodes);
+  std::vector<bool> done(nodes);
+  for (size_t i = 0; i < count; i++) {
+    for (size_t u = 0; u < nodes; u++) {
+      distance[u] = waypoints[u].site == i ? waypoints[u].offset : infinity;
+      done[u] = false;
+    }
+    for (size_t round = 0; round < nodes; round++) {
+      size_t next = nodes;
+      for (size_t u = 0; u < nodes; u++) {
+        if (!done[u] && distance[u] < infinity && (next == nodes || distance[u] < distance[next])) {
+          next = u;
+        }
+      }
+      if (next == nodes) {
+        break;
+      }
+      done[next] = true;
+      const auto* row = &edges[next * nodes];
+      for (size_t v = 0; v < nodes; v++) {
+        distance[v] = std::min(distance[v], distance[next] + row[v]);
+      }
+    }
+    for (size_t u = 0; u < nodes; u++) {
+      auto& route = routes[i * count + waypoints[u].site];
+      route = std::min(route, distance[u] + waypoints[u].offset);
+    }
+  }
+  return routes;
+}
+
+}
+}
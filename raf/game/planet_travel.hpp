@@ -0,0 +1,109 @@
+#ifndef RAF_GAME_PLANET_TRAVEL_H_
+#define RAF_GAME_PLANET_TRAVEL_H_
+
+#include "constants.hpp"
+#include "entity.hpp"
+#include "planet.hpp"
+#include "planet_index.hpp"
+#include "../math/math.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace raf {
+namespace game {
+
+// Waypoints placed around each planet when routing around it.
+constexpr int PLANET_TRAVEL_WAYPOINTS = 8;
+
+// Clearance of waypoints beyond a planet's collision zone.
+constexpr double PLANET_TRAVEL_WAYPOINT_MARGIN = 0.5;
+
+// All pairs distances between planets, built once at the start of the game.
+//
+// Planets never move, so distances between them, and from each planet's
+// spawn_point(), are lookups rather than a sqrt per pair per ship per frame.
+//
+// Travel distances route around the planets in between through a visibility
+// graph of waypoints circling each planet. They assume every planet is still
+// there, destroyed planets only make the real route shorter.
+class PlanetTravelTable {
+public:
+  PlanetTravelTable(const math::Vec2i& dimensions);
+
+  // Build the tables. Call once with the planets of the initial map and an
+  // index built from them.
+  template<typename Container>
+  void build(const Container& planets, const PlanetIndex& index) {
+    sites_.clear();
+    for (const auto& e : planets) {
+      const auto& planet = planet_of(e);
+      sites_.push_back({ planet.id(), planet.current_location(), planet.radius(),
+        spawn_point(planet, dimensions_.x(), dimensions_.y()) });
+    }
+    build_tables(index);
+  }
+
+  bool is_built() const { return !sites_.empty(); }
+
+  // Same as Entity::distance_to_edge between the planets.
+  double edge_distance(EntityId from, EntityId to) const {
+    return edge_distance_[cell(from, to)];
+  }
+
+  // Same as Entity::distance_to_edge_min_turns between the planets.
+  double edge_turns(EntityId from, EntityId to) const {
+    return (edge_distance(from, to) / constants::MAX_SPEED) + 1;
+  }
+
+  // Surface to surface distance between the planets, going round any
+  // planet in the way. Equal to edge_distance when nothing is, infinity if
+  // there is no way round.
+  double travel_distance(EntityId from, EntityId to) const {
+    return travel_distance_[cell(from, to)];
+  }
+
+  // travel_distance in turns, counted as edge_turns counts them.
+  double travel_turns(EntityId from, EntityId to) const {
+    return (travel_distance(from, to) / constants::MAX_SPEED) + 1;
+  }
+
+  // Same as to.distance_to(spawn_point(from, width, height)).
+  double spawn_distance(EntityId from, EntityId to) const {
+    return spawn_distance_[cell(from, to)];
+  }
+
+private:
+  struct Site {
+    EntityId id;
+    math::Vec2d location;
+    double radius;
+    math::Vec2d spawn;
+  };
+
+  static const Planet& planet_of(const Planet& planet) { return planet; }
+  static const Planet& planet_of(const std::pair<const EntityId, Planet>& e) { return e.second; }
+
+  void build_tables(const PlanetIndex& index);
+  // Shortest waypoint route between every pair of planets, or infinity
+  // where there is none.
+  std::vector<double> route_distances(const PlanetIndex& index) const;
+
+  size_t cell(EntityId from, EntityId to) const {
+    return static_cast<size_t>(from) * ids_ + to;
+  }
+
+  math::Vec2i dimensions_;
+  std::vector<Site> sites_;
+  // Tables are ids_ x ids_, indexed by planet id.
+  int ids_;
+  std::vector<double> edge_distance_;
+  std::vector<double> travel_distance_;
+  std::vector<double> spawn_distance_;
+};
+
+}
+}
+
+#endif // !RAF_GAME_PLANET_TRAVEL_H_
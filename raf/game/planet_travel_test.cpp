@@ -0,0 +1,117 @@
+#include "planet_travel.hpp"
+#include "planet.hpp"
+#include "planet_index.hpp"
+#include "raf/math/math.hpp"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+
+using raf::game::EntityId;
+using raf::game::INVALID_ENTITIY_ID;
+using raf::game::Planet;
+using raf::game::PlanetIndex;
+using raf::game::PlanetTravelTable;
+using raf::math::Vec2d;
+using raf::math::Vec2i;
+
+// Non overlapping planets with room to pass between them.
+static std::map<EntityId, Planet> random_planets(const Vec2i& dimensions, int count, std::mt19937& rng) {
+  std::uniform_real_distribution<double> x(15, dimensions.x() - 15);
+  std::uniform_real_distribution<double> y(15, dimensions.y() - 15);
+  std::uniform_real_distribution<double> radius(3, 10);
+  std::map<EntityId, Planet> planets;
+  for (EntityId id = 0; static_cast<int>(planets.size()) < count; ) {
+    const Planet planet(id, INVALID_ENTITIY_ID, { x(rng), y(rng) }, radius(rng), 1000, 3);
+    bool clear = true;
+    for (const auto& e : planets) {
+      clear = clear && planet.distance_to_edge(e.second) > 6;
+    }
+    if (clear) {
+      planets.emplace(id, planet);
+      id++;
+    }
+  }
+  return planets;
+}
+
+TEST(raf_planet_travel, matches_entity_distances)
+{
+  std::mt19937 rng(3);
+  const Vec2i dimensions(288, 192);
+  const auto planets = random_planets(dimensions, 24, rng);
+  PlanetIndex index(dimensions);
+  index.build(planets);
+  PlanetTravelTable table(dimensions);
+  table.build(planets, index);
+  ASSERT_TRUE(table.is_built());
+
+  for (const auto& a : planets) {
+    const auto spawn = raf::game::spawn_point(a.second, dimensions.x(), dimensions.y());
+    for (const auto& b : planets) {
+      ASSERT_EQ(a.second.distance_to_edge(b.second), table.edge_distance(a.first, b.first));
+      ASSERT_EQ(a.second.distance_to_edge_min_turns(b.second), table.edge_turns(a.first, b.first));
+      ASSERT_EQ(b.second.distance_to(spawn), table.spawn_distance(a.first, b.first));
+      if (a.first != b.first) {
+        ASSERT_GE(table.travel_distance(a.first, b.first), table.edge_distance(a.first, b.first));
+        ASSERT_NEAR(table.travel_distance(a.first, b.first), table.travel_distance(b.first, a.first), 1e-9);
+      }
+    }
+  }
+}
+
+TEST(raf_planet_travel, routes_around_planets)
+{
+  const Vec2i dimensions(240, 160);
+  std::map<EntityId, Planet> planets;
+  planets.emplace(0, Planet(0, INVALID_ENTITIY_ID, { 40, 80 }, 4, 1000, 3));
+  planets.emplace(1, Planet(1, INVALID_ENTITIY_ID, { 200, 80 }, 4, 1000, 3));
+  planets.emplace(2, Planet(2, INVALID_ENTITIY_ID, { 120, 80 }, 20, 1000, 3));
+  planets.emplace(3, Planet(3, INVALID_ENTITIY_ID, { 40, 20 }, 4, 1000, 3));
+  PlanetIndex index(dimensions);
+  index.build(planets);
+  PlanetTravelTable table(dimensions);
+  table.build(planets, index);
+
+  // Nothing between 0 and 3.
+  ASSERT_EQ(table.edge_distance(0, 3), table.travel_distance(0, 3));
+  ASSERT_DOUBLE_EQ(52, table.travel_distance(0, 3));
+
+  // 2 sits between 0 and 1. The shortest way round hugs 2, tangent lines
+  // to its collision zone and the arc between them.
+  const double straight = table.edge_distance(0, 1);
+  ASSERT_DOUBLE_EQ(152, straight);
+  const double zone = 20 + raf::constants::FORECAST_FUDGE_FACTOR;
+  const double tangent = std::sqrt(80.0 * 80.0 - zone * zone);
+  const double arc = zone * (M_PI - 2 * std::acos(zone / 80.0));
+  const double shortest = 2 * tangent + arc - 2 * 4;
+  const double travel = table.travel_distance(0, 1);
+  ASSERT_GT(travel, straight);
+  ASSERT_GE(travel, shortest - 1e-9);
+  // Waypoints cut corners a little wide.
+  ASSERT_LT(travel, shortest + 10);
+  ASSERT_DOUBLE_EQ(travel / raf::constants::MAX_SPEED + 1, table.travel_turns(0, 1));
+}
+
+// Timing only, run with --gtest_also_run_disabled_tests.
+TEST(raf_planet_travel, DISABLED_benchmark_build)
+{
+  using Clock = std::chrono::steady_clock;
+  std::mt19937 rng(1);
+  const Vec2i dimensions(384, 256);
+  const auto planets = random_planets(dimensions, 28, rng);
+  PlanetIndex index(dimensions);
+  index.build(planets);
+  PlanetTravelTable table(dimensions);
+
+  const int rounds = 5;
+  const auto start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    table.build(planets, index);
+  }
+  const auto elapsed = Clock::now() - start;
+  std::cout << planets.size() << " planets: build "
+    << std::chrono::duration<double, std::milli>(elapsed).count() / rounds << "ms" << std::endl;
+}
@@ -1,11 +1,13 @@
 #ifndef RAF_PLAYER_H_
 #define RAF_PLAYER_H_
 
+#include "nearest.hpp"
 #include "planet.hpp"
 #include "ship.hpp"
 
 #include <algorithm>
 #include <map>
+#include <vector>
 
 namespace raf {
 namespace game {
@@ -42,27 +44,28 @@ public:
   void update(const hlt::Ship& ship);
 
   game::Planet nearest_planet_to(const game::Entity& entity) const {
-    auto element = std::min_element(
-      planets_.cbegin(),
-      planets_.cend(),
-      [&entity](const decltype(planets_)::value_type& a, const decltype(planets_)::value_type& b) {
-      return entity.distance_to(a.second) < entity.distance_to(b.second);
-    });
-
-    return element->second;
+    return planets_.at(nearest_planet_ids(entity, 1).at(0));
   }
 
   game::Ship nearest_ship_to(const game::Entity& entity) const {
-    auto element = std::min_element(
-      ships_.cbegin(),
-      ships_.cend(),
-      [&entity](const decltype(ships_)::value_type& a, const decltype(ships_)::value_type& b) {
-      return entity.distance_to(a.second) < entity.distance_to(b.second);
-    });
-
-    return element->second;
+    return ships_.at(nearest_ship_ids(entity, 1).at(0));
   }
 
+  // Ids of up to k planets nearest to entity, nearest first.
+  std::vector<EntityId> nearest_planet_ids(
+    const game::Entity& entity,
+    size_t k,
+    const NearestFilter& filter = NearestFilter()) const {
+    return k_nearest(planets_, entity.current_location(), k, filter);
+  }
+
+  // Ids of up to k ships nearest to entity, nearest first.
+  std::vector<EntityId> nearest_ship_ids(
+    const game::Entity& entity,
+    size_t k,
+    const NearestFilter& filter = NearestFilter()) const {
+    return k_nearest(ships_, entity.current_location(), k, filter);
+  }
 
 private:
   PlayerId id_;
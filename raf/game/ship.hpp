@@ -19,12 +19,15 @@ enum class DockingStatus {
 class Ship : public Entity {
 public:
   Ship(EntityId id, EntityId owner_id, const math::Vec2d& initial_location, double radius, int health)
-    : Entity(id, owner_id, initial_location, radius, health) {
+    : Entity(id, owner_id, initial_location, radius, health),
+    docking_status_(DockingStatus::Undocked),
+    docking_progress(0) {
   }
 
   Ship(const hlt::Ship& ship);
   void update(const hlt::Ship& ship);
 
+  DockingStatus docking_status() const { return docking_status_; }
   bool is_undocked() const { return docking_status_ == DockingStatus::Undocked; }
   bool is_docking() const { return docking_status_ == DockingStatus::Docking; }
   bool is_docked() const { return docking_status_ == DockingStatus::Docked; }
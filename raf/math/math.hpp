@@ -5,6 +5,8 @@
 #include <array>
 #include <cmath>
 #include <iostream>
+#include <limits>
+#include <utility>
 #include "../game/constants.hpp"
 
 namespace raf {
@@ -88,11 +90,8 @@ public:
     return { lhs.x_ / rhs, lhs.y_ / rhs };
   }
 
-  Vec2<T> &operator=(const Vec2<T>& rhs) {
-    x_ = rhs.x_;
-    y_ = rhs.y_;
-    return *this;
-  }
+  // Defaulted so Vec2 and the entities holding it stay trivially copyable.
+  Vec2<T> &operator=(const Vec2<T>& rhs) = default;
 
   friend bool operator==(const Vec2<T>& lhs, const Vec2<T>& rhs) {
     return lhs.x_ == rhs.x_ && lhs.y_ == rhs.y_;
@@ -141,6 +140,32 @@ using Vec2i = Vec2<int>;
 //  return std::atan2(dxdy.y(), dxdy.x()) + 2 * M_PI;
 //}
 
+// The point radius away from origin in the direction of towards. This is
+// origin + radius * (cos(a), sin(a)) with a = origin.orient_towards_in_rad(towards),
+// found by normalising the offset rather than going through atan2, cos and sin.
+//
+// Each component differs from the trig version by at most
+// 4e-15 * radius + DBL_EPSILON * (|origin.x| + |origin.y| + radius): a few ulp
+// of the unit direction plus the rounding of the final addition. That is far
+// below what the engine can see once a move is rounded to whole degrees and
+// thrust. When origin == towards the point is radius along +x, as
+// atan2(0, 0) == 0 gave before.
+template<typename T>
+Vec2<T> point_towards(const Vec2<T>& origin, const Vec2<T>& towards, const double radius) {
+  const double dx = towards.x() - origin.x();
+  const double dy = towards.y() - origin.y();
+  const double length = std::sqrt(dx * dx + dy * dy);
+  if (length == 0) {
+    return { origin.x() + radius, origin.y() };
+  }
+  const double scale = radius / length;
+  return { origin.x() + dx * scale, origin.y() + dy * scale };
+}
+
+// Deliberately not point_towards: the point sits exactly on the edge of the
+// target's FORECAST_FUDGE_FACTOR collision zone, so whether a path ending there
+// counts as blocked is decided by the last bit of the coordinates. Changing how
+// it is computed changes which moves get emitted.
 template<typename T>
 Vec2<T> get_closest_point(const Vec2<T>& target, const Vec2<T>& subject, const double target_radius) {
   const double radius = target_radius + constants::MIN_DISTANCE_FOR_CLOSEST_POINT;
@@ -156,38 +181,89 @@ Vec2<T> get_closest_point(const Vec2<T>& target, const Vec2<T>& subject, const d
 }
 
 
+// Every move the engine accepts is an integer thrust in [0, MAX_SPEED] and an
+// integer angle in [0, 360). This table holds the displacement of each one,
+// computed exactly as thrust * cos(angle) so lookups match the trig they
+// replace bit for bit.
+class MoveTable {
+public:
+  static constexpr int DEGREES = 360;
+  static constexpr int THRUSTS = constants::MAX_SPEED + 1;
+
+  static bool in_range(int thrust, int angle_in_degrees) {
+    return thrust >= 0 && thrust < THRUSTS && angle_in_degrees >= 0 && angle_in_degrees < DEGREES;
+  }
+
+  static Vec2d compute(int thrust, int angle_in_degrees) {
+    auto angle_rads = angle_in_degrees * M_PI / 180.0;
+    return Vec2d{ thrust * std::cos(angle_rads), thrust * std::sin(angle_rads) };
+  }
+
+  // thrust and angle_in_degrees must be in range.
+  const Vec2d& displacement(int thrust, int angle_in_degrees) const {
+    return table_[thrust * DEGREES + angle_in_degrees];
+  }
+
+  static const MoveTable& instance() {
+    static const MoveTable table;
+    return table;
+  }
+
+private:
+  MoveTable() {
+    for (int thrust = 0; thrust < THRUSTS; thrust++) {
+      for (int angle = 0; angle < DEGREES; angle++) {
+        table_[thrust * DEGREES + angle] = compute(thrust, angle);
+      }
+    }
+  }
+
+  std::array<Vec2d, THRUSTS * DEGREES> table_;
+};
+
+// A move as the engine sees it, a canonical (thrust, angle) pair with
+// thrust >= 0 and angle in [0, 360), along with its displacement vector.
+//
+// Velocities built from a thrust and angle look their vector up in the
+// MoveTable. Velocities built from an arbitrary vector keep that vector and
+// round it to the nearest move once, on construction.
 class Velocity {
 public:
-  Velocity(int thrust, int angle_in_degrees) :
-    velocity_(thrust_angle_deg_to_vector(thrust, angle_in_degrees)) {
+  Velocity(int thrust, int angle_in_degrees) {
+    // A negative thrust is the same move pointing the other way.
+    if (thrust < 0) {
+      thrust = -thrust;
+      angle_in_degrees += 180;
+    }
+    thrust_ = thrust;
+    degree_ = thrust == 0 ? 0 : ((angle_in_degrees % 360) + 360) % 360;
+    velocity_ = MoveTable::in_range(thrust_, degree_)
+      ? MoveTable::instance().displacement(thrust_, degree_)
+      : MoveTable::compute(thrust_, degree_);
   }
 
   Velocity(double x, double y)
-    : velocity_(x, y) {
+    : Velocity(Vec2d(x, y)) {
   }
 
   Velocity(const Vec2d& vec)
-    : velocity_(vec) {
+    : thrust_(static_cast<int>(std::lround(vec.length()))),
+    degree_(angle_rad_to_deg_clipped(std::atan2(vec.y(), vec.x()) + 2 * M_PI)),
+    velocity_(vec) {
+    if (thrust_ == 0) {
+      degree_ = 0;
+    }
   }
 
-  //raf::math::Vec2d accelerate_by(const raf::math::Vec2d& position) const
-  //{
-  //  raf::math::Vec2d new_position = position;
-  //  new_position += to_vec();
-  //  return new_position;
-  //}
-
   raf::math::Vec2d to_vec() const {
     return velocity_;
   }
 
-  // This should really be some epsilon type adjustment in order to prevent
-  // Situations where thrust is x.9999 and rounded down.
-  int thrust() const { return static_cast<int>(std::sqrt(thrust_squared()) + 0.5); }
-  int angle_in_degrees() const { return angle_rad_to_deg_clipped(angle_rad()); }
+  int thrust() const { return thrust_; }
+  int angle_in_degrees() const { return degree_; }
 
   double angle_rad() const {
-    return std::atan2(velocity_.y(), velocity_.x()) + 2 * M_PI;
+    return degree_ * M_PI / 180.0;
   }
 
   double thrust_squared() const {
@@ -195,12 +271,8 @@ public:
   }
 
 private:
-
-  static raf::math::Vec2d thrust_angle_deg_to_vector(int thrust, int angle_in_degrees) {
-    auto angle_rads = angle_in_degrees * M_PI / 180.0;
-    return raf::math::Vec2d{ thrust * std::cos(angle_rads), thrust * std::sin(angle_rads) };
-  }
-
+  int thrust_;
+  int degree_;
   Vec2d velocity_;
 };
 
@@ -268,6 +340,38 @@ private:
   Vec2<value_type> origin_;
 };
 
+// Ships within this distance of each other have met up.
+constexpr double RENDEZVOUS_DISTANCE = 2.0;
+
+// Where two ships that can each move reach this turn should head to meet up
+// on their way to target:
+// - already within RENDEZVOUS_DISTANCE, the target itself;
+// - too far apart to meet this turn, their midpoint, so both close at full
+//   speed;
+// - otherwise the intersection of their reach circles nearer the target.
+//
+// Equal radii put both intersections on the perpendicular bisector, so this
+// is intersects() for that case without the general circle terms.
+static Vec2d rendezvous_point(const Vec2d& a, const Vec2d& b, const Vec2d& target, double reach) {
+  const auto dxdy = b - a;
+  const auto distance_squared = dxdy.length_squared();
+  const auto reach_squared = reach * reach;
+  const Vec2d midpoint = a + dxdy * 0.5;
+  if (distance_squared < RENDEZVOUS_DISTANCE * RENDEZVOUS_DISTANCE) {
+    return target;
+  }
+  if (4 * reach_squared < distance_squared) {
+    return midpoint;
+  }
+
+  // Half the chord over the distance apart. Clamped since rounding can take
+  // it just below zero when the circles only touch.
+  const auto scale = std::sqrt(std::max(0.0, reach_squared / distance_squared - 0.25));
+  const Vec2d offset(-dxdy.y() * scale, dxdy.x() * scale);
+  // |m + o - t|^2 - |m - o - t|^2 == -4 * o.(t - m)
+  return dot_product(offset, target - midpoint) < 0 ? midpoint - offset : midpoint + offset;
+}
+
 
 
 static double min_dist_squared(
@@ -356,6 +460,43 @@ static double min_dist_squared(
   return min_dist_squared(a, a_vel.to_vec(), b, b_vel.to_vec());
 }
 
+// Times, in turns from now, at which two points moving at constant velocity
+// come within distance of each other and separate again. Uses the same
+// quadratic as min_dist_squared, but solved for D**2 == distance**2 and not
+// limited to one turn. Both are infinity if they never come within distance,
+// and the first is 0 if they already are.
+static std::pair<double, double> approach_interval(
+  const raf::math::Vec2d& a,
+  const raf::math::Vec2d& a_vel,
+  const raf::math::Vec2d& b,
+  const raf::math::Vec2d& b_vel,
+  double distance)
+{
+  constexpr auto never = std::numeric_limits<double>::infinity();
+  const auto diff_position = a - b;
+  const auto diff_velocity = a_vel - b_vel;
+
+  const auto A = diff_velocity.length_squared();
+  const auto B = 2 * dot_product(diff_position, diff_velocity);
+  const auto C = diff_position.length_squared() - distance * distance;
+  if (A == 0) {
+    // Distance apart is constant.
+    return C <= 0 ? std::make_pair(0.0, never) : std::make_pair(never, never);
+  }
+
+  const auto discriminant = B * B - 4 * A * C;
+  if (discriminant < 0) {
+    return { never, never };
+  }
+  const auto root = std::sqrt(discriminant);
+  const auto exit = (-B + root) / (2 * A);
+  if (exit < 0) {
+    // Closest approach is in the past.
+    return { never, never };
+  }
+  return { std::max(0.0, (-B - root) / (2 * A)), exit };
+}
+
 
 constexpr double degrees_to_rads(double degrees) {
   return degrees * M_PI / 180.0;
@@ -1,7 +1,13 @@
 #include "math.hpp"
+#include "vec2x4.hpp"
 
 #include "gtest/gtest.h"
 
+#include <cfloat>
+#include <chrono>
+#include <random>
+#include <vector>
+
 using namespace raf::math;
 
 TEST(raf_math, basic_vec2_a)
@@ -150,9 +156,7 @@ TEST(raf_math, velocity_looped)
         ASSERT_EQ(angle_deg, a.angle_in_degrees());
       } else {
         ASSERT_EQ(0, a.thrust());
-        // FIXME
-        // Signed zero (-0) in some vectors breaks this test.
-        //ASSERT_EQ(0, a.angle_in_degrees());
+        ASSERT_EQ(0, a.angle_in_degrees());
       }
     }
   }
@@ -173,5 +177,316 @@ TEST(raf_math, velocity_angle_wrapped)
   }
 }
 
+TEST(raf_math, move_table_matches_trig)
+{
+  const auto& table = MoveTable::instance();
+  for (int thrust = 0; thrust <= raf::constants::MAX_SPEED; thrust++) {
+    for (int angle_deg = 0; angle_deg < 360; angle_deg++) {
+      const auto angle_rads = angle_deg * M_PI / 180.0;
+      const auto& displacement = table.displacement(thrust, angle_deg);
+      // Bit for bit, not approximately.
+      ASSERT_EQ(thrust * std::cos(angle_rads), displacement.x());
+      ASSERT_EQ(thrust * std::sin(angle_rads), displacement.y());
+    }
+  }
+}
+
+TEST(raf_math, velocity_canonical)
+{
+  const Velocity wrapped{ 3, 370 };
+  ASSERT_EQ(3, wrapped.thrust());
+  ASSERT_EQ(10, wrapped.angle_in_degrees());
+
+  const Velocity negative{ 3, -10 };
+  ASSERT_EQ(350, negative.angle_in_degrees());
+
+  const Velocity reversed{ -3, 270 };
+  ASSERT_EQ(3, reversed.thrust());
+  ASSERT_EQ(90, reversed.angle_in_degrees());
+
+  const Velocity table{ 5, 123 };
+  ASSERT_EQ(MoveTable::instance().displacement(5, 123).x(), table.to_vec().x());
+  ASSERT_EQ(MoveTable::instance().displacement(5, 123).y(), table.to_vec().y());
+
+  // Faster than the engine allows, so off the table.
+  const Velocity fast{ 9, 45 };
+  ASSERT_EQ(9, fast.thrust());
+  ASSERT_DOUBLE_EQ(81, fast.thrust_squared());
+}
+
+TEST(raf_math, velocity_from_vector_rounds_once)
+{
+  for (int thrust = 1; thrust <= raf::constants::MAX_SPEED; thrust++) {
+    for (int angle_deg = 0; angle_deg < 360; angle_deg++) {
+      const Velocity move{ thrust, angle_deg };
+      const Velocity round_trip{ move.to_vec() };
+      ASSERT_EQ(thrust, round_trip.thrust());
+      ASSERT_EQ(angle_deg, round_trip.angle_in_degrees());
+    }
+  }
+
+  // A vector just short of a whole thrust still rounds to it.
+  const Velocity almost{ Vec2d(6.9999999, 0) };
+  ASSERT_EQ(7, almost.thrust());
+  ASSERT_EQ(0, almost.angle_in_degrees());
+  ASSERT_EQ(6.9999999, almost.to_vec().x());
+
+  const Velocity zero{ Vec2d(-0.0, -0.0) };
+  ASSERT_EQ(0, zero.thrust());
+  ASSERT_EQ(0, zero.angle_in_degrees());
+}
+
+static Vec2dArray random_vectors(size_t n, double range, std::mt19937& rng) {
+  std::uniform_real_distribution<double> coordinate(-range, range);
+  Vec2dArray vectors;
+  for (size_t i = 0; i < n; i++) {
+    vectors.push_back({ coordinate(rng), coordinate(rng) });
+  }
+  return vectors;
+}
+
+// Sizes that leave every possible remainder after the four wide lanes.
+TEST(raf_math, batch_length_squared_and_dot)
+{
+  std::mt19937 rng(3);
+  for (size_t n : { 0, 1, 2, 3, 4, 5, 7, 8, 33 }) {
+    const auto a = random_vectors(n, 100, rng);
+    const auto b = random_vectors(n, 100, rng);
+    std::vector<double> lengths;
+    std::vector<double> dots;
+    length_squared(a, lengths);
+    dot_product(a, b, dots);
+    ASSERT_EQ(n, lengths.size());
+    ASSERT_EQ(n, dots.size());
+    for (size_t i = 0; i < n; i++) {
+      ASSERT_EQ(a[i].length_squared(), lengths[i]);
+      ASSERT_EQ(dot_product(a[i], b[i]), dots[i]);
+    }
+  }
+}
+
+TEST(raf_math, batch_min_dist_squared)
+{
+  std::mt19937 rng(8);
+  const auto a = random_vectors(1001, 50, rng);
+  auto a_vel = random_vectors(1001, 7, rng);
+  // Parallel equal velocities (A == 0), and a mover standing still.
+  const Vec2d b(3, -4);
+  const Vec2d b_vel(2, 1);
+  a_vel.x[5] = b_vel.x();
+  a_vel.y[5] = b_vel.y();
+  a_vel.x[6] = 0;
+  a_vel.y[6] = 0;
+
+  std::vector<double> many;
+  min_dist_squared(a, a_vel, b, b_vel, many);
+  for (size_t i = 0; i < a.size(); i++) {
+    ASSERT_EQ(min_dist_squared(a[i], a_vel[i], b, b_vel), many[i]) << i;
+  }
+
+  std::vector<double> candidates;
+  min_dist_squared(a[0], a_vel[0], b, a_vel, candidates);
+  for (size_t i = 0; i < a_vel.size(); i++) {
+    ASSERT_EQ(min_dist_squared(a[0], a_vel[0], b, a_vel[i]), candidates[i]) << i;
+  }
+
+  // Moving apart from the start keeps the starting distance.
+  Vec2dArray apart;
+  apart.push_back({ 1, 0 });
+  min_dist_squared({ 0, 0 }, { 0, 0 }, { 2, 0 }, apart, candidates);
+  ASSERT_EQ(4.0, candidates[0]);
+}
 
+TEST(raf_math, DISABLED_benchmark_batch_min_dist_squared)
+{
+  using Clock = std::chrono::steady_clock;
+  std::mt19937 rng(1);
+  const size_t n = 2520;
+  const int rounds = 2000;
+  const auto a = random_vectors(n, 50, rng);
+  const auto a_vel = random_vectors(n, 7, rng);
+  const Vec2d b(0, 0);
+  const Vec2d b_vel(3, 3);
+  std::vector<double> batch;
+  std::vector<double> scalar(n);
+
+  auto start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (size_t i = 0; i < n; i++) {
+      scalar[i] = min_dist_squared(a[i], a_vel[i], b, b_vel);
+    }
+  }
+  const auto scalar_time = Clock::now() - start;
 
+  start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    min_dist_squared(a, a_vel, b, b_vel, batch);
+  }
+  const auto batch_time = Clock::now() - start;
+  ASSERT_EQ(scalar, batch);
+
+  const auto per_round = [rounds](Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count() / rounds;
+  };
+  std::cout << n << " vectors (" << vec2x4_kernel() << "): scalar " << per_round(scalar_time)
+    << "us, batch " << per_round(batch_time) << "us" << std::endl;
+}
+
+TEST(raf_math, rendezvous_point)
+{
+  const Vec2d target(0, 20);
+
+  // Already together, head for the target.
+  ASSERT_EQ(target, rendezvous_point({ 0, 0 }, { 1, 0 }, target, 7));
+
+  // Too far apart to meet this turn, close on the midpoint.
+  ASSERT_EQ(Vec2d(10, 0), rendezvous_point({ -5, 0 }, { 25, 0 }, target, 7));
+
+  // The reach circles cross at (3, +-4), take the one towards the target.
+  const auto point = rendezvous_point({ 0, 0 }, { 6, 0 }, { 3, 20 }, 5);
+  ASSERT_DOUBLE_EQ(3, point.x());
+  ASSERT_DOUBLE_EQ(4, point.y());
+  const auto below = rendezvous_point({ 0, 0 }, { 6, 0 }, { 3, -20 }, 5);
+  ASSERT_DOUBLE_EQ(-4, below.y());
+
+  // Touching circles meet at the midpoint.
+  const auto touching = rendezvous_point({ 0, 0 }, { 14, 0 }, target, 7);
+  ASSERT_DOUBLE_EQ(7, touching.x());
+  ASSERT_DOUBLE_EQ(0, touching.y());
+}
+
+// rendezvous_point picks one of the points intersects() finds.
+TEST(raf_math, rendezvous_point_matches_intersects)
+{
+  std::mt19937 rng(12);
+  const auto a = random_vectors(500, 30, rng);
+  const auto b = random_vectors(500, 30, rng);
+  const auto targets = random_vectors(500, 100, rng);
+  const double reach = 7;
+  for (size_t i = 0; i < a.size(); i++) {
+    std::array<Vec2d, 2> intersections;
+    if ((a[i] - b[i]).length_squared() < RENDEZVOUS_DISTANCE * RENDEZVOUS_DISTANCE
+      || !intersects(Circle(reach, a[i]), Circle(reach, b[i]), intersections)) {
+      continue;
+    }
+    const auto point = rendezvous_point(a[i], b[i], targets[i], reach);
+    const auto& nearer = (intersections[0] - targets[i]).length_squared() <= (intersections[1] - targets[i]).length_squared()
+      ? intersections[0] : intersections[1];
+    ASSERT_NEAR(nearer.x(), point.x(), 1e-9) << i;
+    ASSERT_NEAR(nearer.y(), point.y(), 1e-9) << i;
+  }
+}
+
+TEST(raf_math, batch_rendezvous_points)
+{
+  std::mt19937 rng(5);
+  for (size_t n : { 0, 1, 3, 4, 5, 8, 1001 }) {
+    auto a = random_vectors(n, 20, rng);
+    auto b = random_vectors(n, 20, rng);
+    const auto targets = random_vectors(n, 100, rng);
+    // Coincident ships and touching reach circles.
+    if (n > 4) {
+      b.x[1] = a.x[1];
+      b.y[1] = a.y[1];
+      b.x[2] = a.x[2] + 14;
+      b.y[2] = a.y[2];
+    }
+    Vec2dArray out;
+    rendezvous_points(a, b, targets, 7, out);
+    ASSERT_EQ(n, out.size());
+    for (size_t i = 0; i < n; i++) {
+      const auto expected = rendezvous_point(a[i], b[i], targets[i], 7);
+      ASSERT_EQ(expected.x(), out.x[i]) << i;
+      ASSERT_EQ(expected.y(), out.y[i]) << i;
+    }
+  }
+}
+
+TEST(raf_math, DISABLED_benchmark_batch_rendezvous_points)
+{
+  using Clock = std::chrono::steady_clock;
+  std::mt19937 rng(2);
+  const size_t n = 2520;
+  const int rounds = 2000;
+  // Partners within a couple of turns of each other, as attacking pairs are.
+  const auto a = random_vectors(n, 100, rng);
+  const auto offsets = random_vectors(n, 14, rng);
+  Vec2dArray b;
+  for (size_t i = 0; i < n; i++) {
+    b.push_back(a[i] + offsets[i]);
+  }
+  const auto targets = random_vectors(n, 100, rng);
+  Vec2dArray batch;
+  Vec2dArray scalar;
+  scalar.resize(n);
+
+  auto start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    for (size_t i = 0; i < n; i++) {
+      const auto point = rendezvous_point(a[i], b[i], targets[i], 7);
+      scalar.x[i] = point.x();
+      scalar.y[i] = point.y();
+    }
+  }
+  const auto scalar_time = Clock::now() - start;
+
+  start = Clock::now();
+  for (int round = 0; round < rounds; round++) {
+    rendezvous_points(a, b, targets, 7, batch);
+  }
+  const auto batch_time = Clock::now() - start;
+  ASSERT_EQ(scalar.x, batch.x);
+  ASSERT_EQ(scalar.y, batch.y);
+
+  const auto per_round = [rounds](Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count() / rounds;
+  };
+  std::cout << n << " pairs (" << vec2x4_kernel() << "): scalar " << per_round(scalar_time)
+    << "us, batch " << per_round(batch_time) << "us" << std::endl;
+}
+
+// The trig version point_towards replaced.
+static Vec2d point_towards_trig(const Vec2d& origin, const Vec2d& towards, double radius) {
+  const double angle_rad = origin.orient_towards_in_rad(towards);
+  return { origin.x() + radius * std::cos(angle_rad), origin.y() + radius * std::sin(angle_rad) };
+}
+
+TEST(raf_math, point_towards_error_bound)
+{
+  std::mt19937 rng(12);
+  std::uniform_real_distribution<double> coordinate(0, 384);
+  std::uniform_real_distribution<double> radius(0.1, 40);
+  std::uniform_real_distribution<double> nudge(-1e-6, 1e-6);
+  for (int i = 0; i < 200000; i++) {
+    const Vec2d origin(coordinate(rng), coordinate(rng));
+    // Include targets almost on top of the origin.
+    const Vec2d towards = (i % 10 == 0)
+      ? origin + Vec2d(nudge(rng), nudge(rng))
+      : Vec2d(coordinate(rng), coordinate(rng));
+    const double r = radius(rng);
+
+    const auto expected = point_towards_trig(origin, towards, r);
+    const auto actual = point_towards(origin, towards, r);
+    const double bound = 4e-15 * r + DBL_EPSILON * (std::fabs(origin.x()) + std::fabs(origin.y()) + r);
+    ASSERT_LE(std::fabs(expected.x() - actual.x()), bound) << origin << towards;
+    ASSERT_LE(std::fabs(expected.y() - actual.y()), bound) << origin << towards;
+    ASSERT_NEAR(r, (actual - origin).length(), bound);
+  }
+}
+
+TEST(raf_math, point_towards_same_point)
+{
+  const Vec2d origin(10, 20);
+  const auto point = point_towards(origin, origin, 3.0);
+  ASSERT_EQ(13, point.x());
+  ASSERT_EQ(20, point.y());
+  ASSERT_EQ(point_towards_trig(origin, origin, 3.0).x(), point.x());
+  ASSERT_EQ(point_towards_trig(origin, origin, 3.0).y(), point.y());
+}
+
+TEST(raf_math, get_closest_point)
+{
+  const auto point = get_closest_point(Vec2d(10, 10), Vec2d(20, 10), 2.0);
+  ASSERT_DOUBLE_EQ(10 + 2.0 + raf::constants::MIN_DISTANCE_FOR_CLOSEST_POINT, point.x());
+  ASSERT_DOUBLE_EQ(10, point.y());
+}
@@ -0,0 +1,391 @@
+#ifndef RAF_MATH_VEC2X4_H_
+#define RAF_MATH_VEC2X4_H_
+
+#include "math.hpp"
+
+#include <vector>
+
+#if !defined(RAF_NO_SIMD) && defined(__AVX__)
+#define RAF_MATH_AVX
+#include <immintrin.h>
+#elif !defined(RAF_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RAF_MATH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace raf {
+namespace math {
+
+// Four doubles operated on together, in one AVX register, two SSE2 registers
+// or a plain array depending on the build (define RAF_NO_SIMD for the array).
+//
+// Only the operations Vec2d itself uses are provided, and each maps to a
+// single IEEE operation per lane, so batch results match the scalar code bit
+// for bit as long as the compiler is not allowed to fuse multiply-adds. The
+// builds turn contraction off (-ffp-contract=off, /fp:precise), and the batch
+// tests fail if it is turned back on.
+class Double4 {
+public:
+  static constexpr int LANES = 4;
+
+  static Double4 load(const double* p) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_loadu_pd(p));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_loadu_pd(p), _mm_loadu_pd(p + 2));
+#else
+    return Double4(p[0], p[1], p[2], p[3]);
+#endif
+  }
+
+  static Double4 broadcast(double v) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_set1_pd(v));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_set1_pd(v), _mm_set1_pd(v));
+#else
+    return Double4(v, v, v, v);
+#endif
+  }
+
+  void store(double* p) const {
+#if defined(RAF_MATH_AVX)
+    _mm256_storeu_pd(p, v_);
+#elif defined(RAF_MATH_SSE2)
+    _mm_storeu_pd(p, lo_);
+    _mm_storeu_pd(p + 2, hi_);
+#else
+    for (int i = 0; i < LANES; i++) {
+      p[i] = v_[i];
+    }
+#endif
+  }
+
+  // Flips the sign bit like scalar negation, so -(+0) is -0.
+  friend Double4 operator-(const Double4& a) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_xor_pd(a.v_, _mm256_set1_pd(-0.0)));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_xor_pd(a.lo_, _mm_set1_pd(-0.0)), _mm_xor_pd(a.hi_, _mm_set1_pd(-0.0)));
+#else
+    return Double4(-a.v_[0], -a.v_[1], -a.v_[2], -a.v_[3]);
+#endif
+  }
+
+  friend Double4 operator+(const Double4& a, const Double4& b) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_add_pd(a.v_, b.v_));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_add_pd(a.lo_, b.lo_), _mm_add_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] + b.v_[0], a.v_[1] + b.v_[1], a.v_[2] + b.v_[2], a.v_[3] + b.v_[3]);
+#endif
+  }
+
+  friend Double4 operator-(const Double4& a, const Double4& b) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_sub_pd(a.v_, b.v_));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_sub_pd(a.lo_, b.lo_), _mm_sub_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] - b.v_[0], a.v_[1] - b.v_[1], a.v_[2] - b.v_[2], a.v_[3] - b.v_[3]);
+#endif
+  }
+
+  friend Double4 operator*(const Double4& a, const Double4& b) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_mul_pd(a.v_, b.v_));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_mul_pd(a.lo_, b.lo_), _mm_mul_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] * b.v_[0], a.v_[1] * b.v_[1], a.v_[2] * b.v_[2], a.v_[3] * b.v_[3]);
+#endif
+  }
+
+  friend Double4 operator/(const Double4& a, const Double4& b) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_div_pd(a.v_, b.v_));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_div_pd(a.lo_, b.lo_), _mm_div_pd(a.hi_, b.hi_));
+#else
+    return Double4(a.v_[0] / b.v_[0], a.v_[1] / b.v_[1], a.v_[2] / b.v_[2], a.v_[3] / b.v_[3]);
+#endif
+  }
+
+  // Correctly rounded, like std::sqrt.
+  friend Double4 sqrt(const Double4& a) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_sqrt_pd(a.v_));
+#elif defined(RAF_MATH_SSE2)
+    return Double4(_mm_sqrt_pd(a.lo_), _mm_sqrt_pd(a.hi_));
+#else
+    return Double4(std::sqrt(a.v_[0]), std::sqrt(a.v_[1]), std::sqrt(a.v_[2]), std::sqrt(a.v_[3]));
+#endif
+  }
+
+  // Per lane (a < b) ? if_true : if_false, false when either side is NaN.
+  static Double4 select_less(const Double4& a, const Double4& b, const Double4& if_true, const Double4& if_false) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_blendv_pd(if_false.v_, if_true.v_, _mm256_cmp_pd(a.v_, b.v_, _CMP_LT_OQ)));
+#elif defined(RAF_MATH_SSE2)
+    const __m128d lo = _mm_cmplt_pd(a.lo_, b.lo_);
+    const __m128d hi = _mm_cmplt_pd(a.hi_, b.hi_);
+    return Double4(
+      _mm_or_pd(_mm_and_pd(lo, if_true.lo_), _mm_andnot_pd(lo, if_false.lo_)),
+      _mm_or_pd(_mm_and_pd(hi, if_true.hi_), _mm_andnot_pd(hi, if_false.hi_)));
+#else
+    double out[LANES];
+    for (int i = 0; i < LANES; i++) {
+      out[i] = a.v_[i] < b.v_[i] ? if_true.v_[i] : if_false.v_[i];
+    }
+    return load(out);
+#endif
+  }
+
+  // Per lane (a == b) ? if_true : if_false.
+  static Double4 select_equal(const Double4& a, const Double4& b, const Double4& if_true, const Double4& if_false) {
+#if defined(RAF_MATH_AVX)
+    return Double4(_mm256_blendv_pd(if_false.v_, if_true.v_, _mm256_cmp_pd(a.v_, b.v_, _CMP_EQ_OQ)));
+#elif defined(RAF_MATH_SSE2)
+    const __m128d lo = _mm_cmpeq_pd(a.lo_, b.lo_);
+    const __m128d hi = _mm_cmpeq_pd(a.hi_, b.hi_);
+    return Double4(
+      _mm_or_pd(_mm_and_pd(lo, if_true.lo_), _mm_andnot_pd(lo, if_false.lo_)),
+      _mm_or_pd(_mm_and_pd(hi, if_true.hi_), _mm_andnot_pd(hi, if_false.hi_)));
+#else
+    double out[LANES];
+    for (int i = 0; i < LANES; i++) {
+      out[i] = a.v_[i] == b.v_[i] ? if_true.v_[i] : if_false.v_[i];
+    }
+    return load(out);
+#endif
+  }
+
+private:
+#if defined(RAF_MATH_AVX)
+  explicit Double4(__m256d v) : v_(v) {}
+  __m256d v_;
+#elif defined(RAF_MATH_SSE2)
+  Double4(__m128d lo, __m128d hi) : lo_(lo), hi_(hi) {}
+  __m128d lo_;
+  __m128d hi_;
+#else
+  Double4(double a, double b, double c, double d) : v_{ a, b, c, d } {}
+  double v_[LANES];
+#endif
+};
+
+// Four Vec2d, one per lane.
+struct Vec2x4 {
+  Double4 x;
+  Double4 y;
+
+  static Vec2x4 load(const double* xs, const double* ys) {
+    return { Double4::load(xs), Double4::load(ys) };
+  }
+
+  static Vec2x4 broadcast(const Vec2d& v) {
+    return { Double4::broadcast(v.x()), Double4::broadcast(v.y()) };
+  }
+
+  void store(double* xs, double* ys) const {
+    x.store(xs);
+    y.store(ys);
+  }
+
+  static Vec2x4 select_less(const Double4& a, const Double4& b, const Vec2x4& if_true, const Vec2x4& if_false) {
+    return { Double4::select_less(a, b, if_true.x, if_false.x), Double4::select_less(a, b, if_true.y, if_false.y) };
+  }
+
+  friend Vec2x4 operator+(const Vec2x4& a, const Vec2x4& b) { return { a.x + b.x, a.y + b.y }; }
+  friend Vec2x4 operator-(const Vec2x4& a, const Vec2x4& b) { return { a.x - b.x, a.y - b.y }; }
+  friend Vec2x4 operator*(const Vec2x4& a, const Double4& b) { return { b * a.x, b * a.y }; }
+
+  friend Double4 dot_product(const Vec2x4& a, const Vec2x4& b) { return a.x * b.x + a.y * b.y; }
+  Double4 length_squared() const { return x * x + y * y; }
+};
+
+// Same steps as min_dist_squared(Vec2d...) in every lane.
+inline Double4 min_dist_squared(const Vec2x4& a, const Vec2x4& a_vel, const Vec2x4& b, const Vec2x4& b_vel) {
+  const auto zero = Double4::broadcast(0.0);
+  const auto one = Double4::broadcast(1.0);
+  const auto two = Double4::broadcast(2.0);
+
+  const auto diff_position = a - b;
+  const auto diff_velocity = a_vel - b_vel;
+  const auto A = diff_velocity.length_squared();
+  const auto B = two * dot_product(diff_position, diff_velocity);
+  const auto C = diff_position.length_squared();
+
+  // std::min(1.0, -B / (2 * A)) keeps 1.0 unless the other side is smaller.
+  const auto vertex = -B / (two * A);
+  const auto t = Double4::select_less(vertex, one, vertex, one);
+  const auto at_t = t * t * A + t * B + C;
+
+  // A == 0 and t < 0 both return the distance at t == 0.
+  const auto result = Double4::select_less(t, zero, C, at_t);
+  return Double4::select_equal(A, zero, C, result);
+}
+
+// Vectors in structure-of-arrays form, for the batch helpers below.
+struct Vec2dArray {
+  std::vector<double> x;
+  std::vector<double> y;
+
+  void clear() {
+    x.clear();
+    y.clear();
+  }
+
+  void reserve(size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+  }
+
+  void resize(size_t n) {
+    x.resize(n);
+    y.resize(n);
+  }
+
+  void push_back(const Vec2d& v) {
+    x.push_back(v.x());
+    y.push_back(v.y());
+  }
+
+  Vec2d operator[](size_t i) const { return { x[i], y[i] }; }
+  size_t size() const { return x.size(); }
+};
+
+// out[i] = v[i].length_squared()
+inline void length_squared(const Vec2dArray& v, std::vector<double>& out) {
+  const size_t n = v.size();
+  out.resize(n);
+  size_t i = 0;
+  for (; i + Double4::LANES <= n; i += Double4::LANES) {
+    Vec2x4::load(&v.x[i], &v.y[i]).length_squared().store(&out[i]);
+  }
+  for (; i < n; i++) {
+    out[i] = v[i].length_squared();
+  }
+}
+
+// out[i] = dot_product(a[i], b[i])
+inline void dot_product(const Vec2dArray& a, const Vec2dArray& b, std::vector<double>& out) {
+  const size_t n = a.size();
+  out.resize(n);
+  size_t i = 0;
+  for (; i + Double4::LANES <= n; i += Double4::LANES) {
+    dot_product(Vec2x4::load(&a.x[i], &a.y[i]), Vec2x4::load(&b.x[i], &b.y[i])).store(&out[i]);
+  }
+  for (; i < n; i++) {
+    out[i] = dot_product(a[i], b[i]);
+  }
+}
+
+// out[i] = min_dist_squared(a, a_vel, b, b_vel[i]), one mover against many
+// candidate velocities for another.
+inline void min_dist_squared(
+  const Vec2d& a,
+  const Vec2d& a_vel,
+  const Vec2d& b,
+  const Vec2dArray& b_vel,
+  std::vector<double>& out) {
+  const size_t n = b_vel.size();
+  out.resize(n);
+  const auto a4 = Vec2x4::broadcast(a);
+  const auto a_vel4 = Vec2x4::broadcast(a_vel);
+  const auto b4 = Vec2x4::broadcast(b);
+  size_t i = 0;
+  for (; i + Double4::LANES <= n; i += Double4::LANES) {
+    min_dist_squared(a4, a_vel4, b4, Vec2x4::load(&b_vel.x[i], &b_vel.y[i])).store(&out[i]);
+  }
+  for (; i < n; i++) {
+    out[i] = min_dist_squared(a, a_vel, b, b_vel[i]);
+  }
+}
+
+// out[i] = min_dist_squared(a[i], a_vel[i], b, b_vel), many movers against one.
+inline void min_dist_squared(
+  const Vec2dArray& a,
+  const Vec2dArray& a_vel,
+  const Vec2d& b,
+  const Vec2d& b_vel,
+  std::vector<double>& out) {
+  const size_t n = a.size();
+  out.resize(n);
+  const auto b4 = Vec2x4::broadcast(b);
+  const auto b_vel4 = Vec2x4::broadcast(b_vel);
+  size_t i = 0;
+  for (; i + Double4::LANES <= n; i += Double4::LANES) {
+    min_dist_squared(Vec2x4::load(&a.x[i], &a.y[i]), Vec2x4::load(&a_vel.x[i], &a_vel.y[i]), b4, b_vel4).store(&out[i]);
+  }
+  for (; i < n; i++) {
+    out[i] = min_dist_squared(a[i], a_vel[i], b, b_vel);
+  }
+}
+
+// Same steps as rendezvous_point(Vec2d...) in every lane. Both branches are
+// computed and blended, the lanes a branch does not apply to can hold NaN.
+inline Vec2x4 rendezvous_point(const Vec2x4& a, const Vec2x4& b, const Vec2x4& target, const Double4& reach) {
+  const auto zero = Double4::broadcast(0.0);
+  const auto half = Double4::broadcast(0.5);
+  const auto quarter = Double4::broadcast(0.25);
+  const auto four = Double4::broadcast(4.0);
+  const auto met = Double4::broadcast(RENDEZVOUS_DISTANCE * RENDEZVOUS_DISTANCE);
+
+  const auto dxdy = b - a;
+  const auto distance_squared = dxdy.length_squared();
+  const auto reach_squared = reach * reach;
+  const auto midpoint = a + dxdy * half;
+
+  const auto squared_scale = reach_squared / distance_squared - quarter;
+  const auto scale = sqrt(Double4::select_less(zero, squared_scale, squared_scale, zero));
+  const Vec2x4 offset = { -dxdy.y * scale, dxdy.x * scale };
+  const auto side = dot_product(offset, target - midpoint);
+  auto result = Vec2x4::select_less(side, zero, midpoint - offset, midpoint + offset);
+
+  result = Vec2x4::select_less(four * reach_squared, distance_squared, midpoint, result);
+  return Vec2x4::select_less(distance_squared, met, target, result);
+}
+
+// out[i] = rendezvous_point(a[i], b[i], targets[i], reach), for every pair
+// of ships converging on a target this turn.
+inline void rendezvous_points(
+  const Vec2dArray& a,
+  const Vec2dArray& b,
+  const Vec2dArray& targets,
+  double reach,
+  Vec2dArray& out) {
+  const size_t n = a.size();
+  out.resize(n);
+  const auto reach4 = Double4::broadcast(reach);
+  size_t i = 0;
+  for (; i + Double4::LANES <= n; i += Double4::LANES) {
+    rendezvous_point(
+      Vec2x4::load(&a.x[i], &a.y[i]),
+      Vec2x4::load(&b.x[i], &b.y[i]),
+      Vec2x4::load(&targets.x[i], &targets.y[i]),
+      reach4).store(&out.x[i], &out.y[i]);
+  }
+  for (; i < n; i++) {
+    const auto point = rendezvous_point(a[i], b[i], targets[i], reach);
+    out.x[i] = point.x();
+    out.y[i] = point.y();
+  }
+}
+
+// Name of the lane implementation chosen at build time: "avx", "sse2" or "scalar".
+inline const char* vec2x4_kernel() {
+#if defined(RAF_MATH_AVX)
+  return "avx";
+#elif defined(RAF_MATH_SSE2)
+  return "sse2";
+#else
+  return "scalar";
+#endif
+}
+
+}
+}
+
+#endif // !RAF_MATH_VEC2X4_H_
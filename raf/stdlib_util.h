@@ -3,7 +3,9 @@
 
 #include <algorithm>
 #include <functional>
+#include <iosfwd>
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -100,6 +102,57 @@ void map_erase_if(ContainerT& items, const PredicateT& predicate) {
   }
 }
 
+//
+// Decorated sorting
+//
+
+// Sort items by key(item), calling key once per item rather than twice per
+// comparison. The keys are sorted as compact (key, index) pairs and the
+// items moved into place afterwards.
+//
+// Pairs compare on the key alone, so the result is exactly what std::sort
+// gives with key(a) < key(b) as the comparator, ties included. Scratch space
+// comes from the vector's own allocator.
+template<typename T, typename Alloc, typename KeyFunc>
+void sort_by_key(std::vector<T, Alloc>& items, KeyFunc key) {
+  using Key = decltype(key(items.front()));
+  using KeyedAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<std::pair<Key, size_t>>;
+  std::vector<std::pair<Key, size_t>, KeyedAlloc> keyed(KeyedAlloc(items.get_allocator()));
+  keyed.reserve(items.size());
+  for (size_t i = 0; i < items.size(); i++) {
+    keyed.emplace_back(key(items[i]), i);
+  }
+  std::sort(std::begin(keyed), std::end(keyed), [](const std::pair<Key, size_t>& a, const std::pair<Key, size_t>& b) {
+    return a.first < b.first;
+  });
+
+  std::vector<T, Alloc> sorted(items.get_allocator());
+  sorted.reserve(items.size());
+  for (const auto& e : keyed) {
+    sorted.push_back(std::move(items[e.second]));
+  }
+  items.swap(sorted);
+}
+
+// First element with the smallest key(element), as std::min_element with
+// key(a) < key(b) would find, calling key once per element.
+template<typename Iterator, typename KeyFunc>
+Iterator min_element_by_key(Iterator first, Iterator last, KeyFunc key) {
+  if (first == last) {
+    return last;
+  }
+  auto best = first;
+  auto best_key = key(*first);
+  for (++first; first != last; ++first) {
+    auto k = key(*first);
+    if (k < best_key) {
+      best = first;
+      best_key = k;
+    }
+  }
+  return best;
+}
+
 template<typename T>
 std::ostream& operator<<(std::ostream& os, const std::vector<T>& vec) {
   for (const auto &e : vec) {
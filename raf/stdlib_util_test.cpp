@@ -0,0 +1,67 @@
+#include "stdlib_util.h"
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+using raf::min_element_by_key;
+using raf::sort_by_key;
+
+struct Item {
+  int key;
+  int id;
+};
+
+TEST(raf_stdlib_util, sort_by_key_empty)
+{
+  std::vector<Item> items;
+  sort_by_key(items, [](const Item& a) { return a.key; });
+  ASSERT_TRUE(items.empty());
+}
+
+// Same order as std::sort with the equivalent comparator, including how
+// equal keys end up.
+TEST(raf_stdlib_util, sort_by_key_matches_std_sort)
+{
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int> key(0, 20);
+  for (int n : { 1, 2, 15, 16, 17, 100, 1000 }) {
+    std::vector<Item> items;
+    for (int i = 0; i < n; i++) {
+      items.push_back({ key(rng), i });
+    }
+    auto expected = items;
+    std::sort(std::begin(expected), std::end(expected), [](const Item& a, const Item& b) {
+      return a.key < b.key;
+    });
+
+    int calls = 0;
+    sort_by_key(items, [&calls](const Item& a) {
+      calls++;
+      return a.key;
+    });
+    ASSERT_EQ(n, calls);
+    for (int i = 0; i < n; i++) {
+      ASSERT_EQ(expected[i].id, items[i].id) << "n " << n << " index " << i;
+    }
+  }
+}
+
+TEST(raf_stdlib_util, sort_by_key_moves_items)
+{
+  std::vector<std::string> words = { "ccc", "a", "bb" };
+  sort_by_key(words, [](const std::string& s) { return s.size(); });
+  ASSERT_EQ(std::vector<std::string>({ "a", "bb", "ccc" }), words);
+}
+
+TEST(raf_stdlib_util, min_element_by_key)
+{
+  const std::vector<Item> items = { { 5, 0 }, { 2, 1 }, { 7, 2 }, { 2, 3 } };
+  const auto it = min_element_by_key(items.cbegin(), items.cend(), [](const Item& a) { return a.key; });
+  // First of the equal minimums, as std::min_element.
+  ASSERT_EQ(1, it->id);
+
+  const std::vector<Item> none;
+  ASSERT_EQ(none.cend(), min_element_by_key(none.cbegin(), none.cend(), [](const Item& a) { return a.key; }));
+}